@@ -10,8 +10,6 @@
 #include <iostream>
 #include <vector>
 
-using namespace Minisat;
-
 namespace aalta
 {
     void AaltaSolver::init_solver()
@@ -22,10 +20,13 @@ namespace aalta
 
     bool AaltaSolver::solve_assumption()
     {
-        Minisat::lbool ret = solveLimited(assumption_);
-        if (ret == l_Undef)
+        for (int id : assumption_)
+            sat_->assume(id);
+        solves++;
+        SatSolver::result ret = sat_->solve();
+        if (ret == SatSolver::UNKNOWN)
             exit(0);
-        return (ret == l_True);
+        return (ret == SatSolver::SAT);
     }
 
     // return the model from SAT solver when it provides SAT
@@ -33,13 +34,7 @@ namespace aalta
     {
         std::vector<int> res(nVars(), 0);
         for (int i = 0; i < nVars(); i++)
-        {
-            if (model[i] == l_True)
-                res[i] = i + 1;
-            else if (model[i] == l_False)
-                res[i] = -(i + 1);
-            // TODO: Can it be l_Undef? I don't think so. But the codes indicate so!
-        }
+            res[i] = sat_->val(i + 1); // TODO: Can it be 0 (unassigned)? I don't think so. But the codes indicate so!
         return res;
     }
 
@@ -51,6 +46,7 @@ namespace aalta
      *             JUST SKIP it, needn't to understand so deeply/detailly!
      *       ANSWER: maybe beacause `conflict` shows the assumptions which are not true now
      *              so it (`conflict`) stores the negation of elems in `assumption_` which are not true now.
+     *              (`SatSolver::failed()` negates them back)
      * NOTE: but still have the X problem, we should have X(uc) when try_satisfy
      *       - the X problem is also copied in `add_clause_for_frame()` func.
      * 
@@ -58,76 +54,80 @@ namespace aalta
     std::vector<int> AaltaSolver::get_uc()
     {
         std::vector<int> reason;
-        for (int k = 0; k < conflict.size(); k++)
-        {
-            Minisat::Lit l = conflict[k];
-            reason.push_back(-lit_to_id(l));
-        }
+        sat_->failed(reason);
         return reason;
     }
 
-    Minisat::Lit AaltaSolver::id_to_lit(int id)
-    {
-        assert(id != 0);
-        int var = abs(id) - 1;
-        while (var >= nVars())
-            newVar();
-        // note: Minisat::Lit has overloaded `~` operator, it is equivalent to `^1`
-        return ((id > 0) ? Minisat::mkLit(var) : ~Minisat::mkLit(var));
-    }
-
-    int AaltaSolver::lit_to_id(Minisat::Lit l)
-    {
-        if (sign(l))
-            return -(var(l) + 1);
-        else
-            return var(l) + 1;
-        /**
-         * Why both `+1`? What is the 0th/1th item?
-         *  - Oh, I also see `abs(id)-1` in `id_to_lit()`
-         */
-    }
-
     /**
-     * All others overloading add_clause() all invoke this one!
+     * All add_clause() finally invoke this one!
      * All add_equivalence() finally invoke this one, too.
      *
      * 作用: 在 SAT solver 的“待满足条件”中加上条件  " \/ (vi) "
      */
-    void AaltaSolver::add_clause(std::vector<int> &v)
+    void AaltaSolver::add_lits(const int *v, int n)
     {
-        Minisat::vec<Minisat::Lit> lits;
-        for (std::vector<int>::iterator it = v.begin(); it != v.end(); it++)
-            lits.push(id_to_lit(*it));
         dout << "add_clause:\t";
-        for (std::vector<int>::iterator it = v.begin(); it != v.end(); it++)
-            dout << *it << ", ";
+        for (int i = 0; i < n; i++)
+            dout << v[i] << ", ";
         dout << std::endl;
-        addClause(lits);
+        sat_->add(v, n);
     }
 
-    void AaltaSolver::add_clause(int id)
+    void AaltaSolver::add_clause(const std::vector<int> &v)
     {
-        std::vector<int> v{id};
-        add_clause(v);
+        add_lits(v.data(), v.size());
     }
 
-    void AaltaSolver::add_clause(int id1, int id2)
+    /**
+     * l -> /\ (vi) or l -> \/ (vi)
+     *
+     * @param isAnd: true if l -> /\ (vi), false if l -> \/ (vi)
+     * @param l: l
+     * @param v, n: list of vi
+    */
+    void AaltaSolver::add_implication_wise(bool isAnd, int l, const int *v, int n)
     {
-        std::vector<int> v{id1, id2};
-        add_clause(v);
+        if (isAnd) // ==== l -> /\ (vi)
+        {
+            for (int i = 0; i < n; i++)
+                add_clause(-l, v[i]); // l -> vi === !l \/ vi
+        }
+        else // ==== l -> \/ (vi) === !l \/ [ \/ vi]
+        {
+            lits_.assign(1, -l);
+            lits_.insert(lits_.end(), v, v + n);
+            add_lits(lits_.data(), lits_.size());
+        }
     }
 
-    void AaltaSolver::add_clause(int id1, int id2, int id3)
+    /**
+     * l <- /\ (vi) or l <- \/ (vi)
+     *
+     * @param isAnd: true if l <- /\ (vi), false if l <- \/ (vi)
+    */
+    void AaltaSolver::add_implied_wise(bool isAnd, int l, const int *v, int n)
     {
-        std::vector<int> v{id1, id2, id3};
-        add_clause(v);
+        if (isAnd) // ==== l <- /\ (vi) === [ \/ (!vi)] \/ l
+        {
+            lits_.assign(1, l);
+            for (int i = 0; i < n; i++)
+                lits_.push_back(-v[i]);
+            add_lits(lits_.data(), lits_.size());
+        }
+        else // ==== l <- \/ (vi) === !l -> ![ \/ (vi)] === !l -> /\ (!vi)
+        {
+            for (int i = 0; i < n; i++)
+                add_clause(l, -v[i]); // !l -> !vi === l \/ !vi
+        }
     }
 
-    void AaltaSolver::add_clause(int id1, int id2, int id3, int id4)
+    // NOTE: l -> ... comes first, for both polarities it is the order of the clauses of `add_equivalence_wise()`
+    void AaltaSolver::add_definition_wise(int polarity, bool isAnd, int l, const int *v, int n)
     {
-        std::vector<int> v{id1, id2, id3, id4};
-        add_clause(v);
+        if (polarity & POS_POLARITY)
+            add_implication_wise(isAnd, l, v, n);
+        if (polarity & NEG_POLARITY)
+            add_implied_wise(isAnd, l, v, n);
     }
 
 }
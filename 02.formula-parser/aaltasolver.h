@@ -8,51 +8,106 @@
 #ifndef AALTA_SOLVER_H
 #define AALTA_SOLVER_H
 
-#include "minisat/core/Solver.h"
+#include "satsolver.h"
 #include "formula/aalta_formula.h"
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
 #include <vector>
 #include <iostream>
 
 namespace aalta
 {
-	class AaltaSolver : public Minisat::Solver
+	/**
+	 * the clauses of the checkers over the ids of the afs (and of the flags of the frames), on top of a `SatSolver`,
+	 * whose backend is chosen by `SatSolver::set_default()`.
+	 */
+	class AaltaSolver
 	{
 	public:
-		AaltaSolver() {
+		AaltaSolver() : sat_(SatSolver::create()) {
             init_solver();
         }
-		AaltaSolver(bool verbose) : verbose_(verbose) {
+		AaltaSolver(bool verbose) : verbose_(verbose), sat_(SatSolver::create()) {
+            init_solver();
+        }
+		AaltaSolver(bool verbose, SatSolver::backend backend) : verbose_(verbose), sat_(SatSolver::create(backend)) {
             init_solver();
         }
 
 		// variables
 		bool verbose_;
-		Minisat::vec<Minisat::Lit> assumption_; // Assumption for SAT solver
+		std::vector<int> assumption_; // Assumption for SAT solver, the ids
         std::vector<aalta_formula *> af_list;
-        std::vector<std::string> af_s_list;
         std::vector<int> sat_id_list;
+		uint64_t solves = 0; // the number of `solve_assumption()`, i.e. of the SAT calls
 
 		// functions
         void init_solver();           // !false true
-		bool solve_assumption();	  // invoke Solver::solveLimited() with assumption_
+		bool solve_assumption();	  // invoke SatSolver::solve() with assumption_
 		std::vector<int> get_model(); // get the model from SAT solver
 		std::vector<int> get_uc();	  // get UC from SAT solver
+		// make the running (or the next) `solve_assumption()` give up (it exits then), see `SatSolver::interrupt()`
+		inline void interrupt() { sat_->interrupt(); }
 
-		Minisat::Lit id_to_lit(int id);	// create the Lit used in SAT solver for the id.
-		int lit_to_id(Minisat::Lit);	// return the id of SAT lit
+		inline int nVars() const { return sat_->vars(); }
+		inline int nClauses() const { return sat_->clauses(); }
+		inline const char *backend() const { return sat_->name(); }
+		inline void reserve_vars(int n) { sat_->reserve(n); } // make room for the vars of the ids up to \@n, they are still created on use
+		// see `SatSolver::freeze()` and `SatSolver::preprocess()`
+		inline void freeze(int id) { sat_->freeze(id); }
+		inline bool preprocess() { return sat_->preprocess(); }
+		inline int nEliminated() const { return sat_->eliminated(); }
 
 		// 作用: 在 SAT solver 的“待满足条件”中加上条件
-		void add_clause(int);
-		void add_clause(int, int);
-		void add_clause(int, int, int);
-		void add_clause(int, int, int, int); 
-		void add_clause(std::vector<int> &); // 添加的条件是: " \/ (vi) "
+		// NOTE: the ids are passed to `SatSolver::add()` as they are (an array on the stack or in `lits_`), so nothing is allocated per clause
+		template <typename... Ids>
+		inline void add_clause(int id, Ids... ids); // id \/ ids..., the arity is known at compile time
+		void add_clause(const std::vector<int> &); // 添加的条件是: " \/ (vi) "
 
 		// 作用: 在 SAT solver 的“待满足条件”中加上条件, 与上面 add_clause 的不同在于, 这里添加的都是'等价关系'形式的条件
 		inline void add_equivalence(int l, int r); 					// l <-> r
 		inline void add_equivalence(int l, int r1, int r2); 		// l <-> r1 /\ r2
 		inline void add_equivalence(int l, int r1, int r2, int r3); // l <-> r1 /\ r2 /\ r3
-		inline void add_equivalence_wise(bool isAnd, int l, const std::vector<int> &); // l <-> /\ (vi) or l <-> \/ (vi)
+		inline void add_equivalence_wise(bool isAnd, int l, const int *v, int n) // l <-> /\ (vi) or l <-> \/ (vi)
+		{
+			add_definition_wise(BOTH_POLARITIES, isAnd, l, v, n);
+		}
+		inline void add_equivalence_wise(bool isAnd, int l, const std::vector<int> &v)
+		{
+			add_equivalence_wise(isAnd, l, v.data(), v.size());
+		}
+		inline void add_equivalence_wise(bool isAnd, int l, std::initializer_list<int> v) // e.g. {a, b}, without a vector
+		{
+			add_equivalence_wise(isAnd, l, v.begin(), v.size());
+		}
+
+		// the halves of `add_equivalence_wise()`
+		void add_implication_wise(bool isAnd, int l, const int *v, int n); // l -> /\ (vi) or l -> \/ (vi)
+		void add_implied_wise(bool isAnd, int l, const int *v, int n);	   // l <- /\ (vi) or l <- \/ (vi)
+
+		// the polarities in which a defined literal occurs, see `add_definition_wise()`
+		enum { POS_POLARITY = 1, NEG_POLARITY = 2, BOTH_POLARITIES = POS_POLARITY | NEG_POLARITY };
+		/**
+		 * the definition l <-> /\ (vi) or l <-> \/ (vi), with only the halves needed for the \@polarity of l (Plaisted–Greenbaum):
+		 * l -> ... if l occurs positively, l <- ... if it occurs negatively.
+		 * e.g. if l is only ever assumed (or required) to be true, a model with l true still satisfies the whole definition,
+		 * and l may be false in a model even though the definition is true.
+		 */
+		void add_definition_wise(int polarity, bool isAnd, int l, const int *v, int n);
+		inline void add_definition_wise(int polarity, bool isAnd, int l, const std::vector<int> &v)
+		{
+			add_definition_wise(polarity, isAnd, l, v.data(), v.size());
+		}
+		inline void add_definition_wise(int polarity, bool isAnd, int l, std::initializer_list<int> v)
+		{
+			add_definition_wise(polarity, isAnd, l, v.begin(), v.size());
+		}
+
+	private:
+		std::unique_ptr<SatSolver> sat_;
+		std::vector<int> lits_;				  // the scratch clause of the n-ary clauses, reused by every clause
+		void add_lits(const int *v, int n); // add the clause \/ (vi)
 	};
 
 	///////////inline functions
@@ -80,42 +135,11 @@ namespace aalta
         add_clause(l, -r1, -r2, -r3);
     }
 
-    /**
-     * l <-> /\ (vi) or l <-> \/ (vi)
-     * 
-     * @param isAnd: true if l <-> /\ (vi), false if l <-> \/ (vi)
-     * @param l: l
-     * @param v: list of vi
-    */
-    inline void AaltaSolver::add_equivalence_wise(bool isAnd, int l, const std::vector<int> &v)
+    template <typename... Ids>
+    inline void AaltaSolver::add_clause(int id, Ids... ids)
     {
-        if(isAnd) // l <-> /\ (vi)
-        {
-            // ==== l -> /\ (vi)
-            for (std::vector<int>::const_iterator it = v.begin(); it != v.end(); it++)
-                add_clause(-l, *it); // l -> vi === !l \/ vi
-
-            // ==== l <- /\ (vi) === [ \/ (!vi)] \/ l
-            std::vector<int> new_v;
-            new_v.push_back(l);
-            for (std::vector<int>::const_iterator it = v.begin(); it != v.end(); it++)
-                new_v.push_back(-*it);
-            add_clause(new_v);
-        }
-        else    // l <-> \/ (vi)
-        {
-            // ==== l -> \/ (vi) === !l \/ [ \/ vi]
-            std::vector<int> new_v;
-            new_v.push_back(-l);
-            for (std::vector<int>::const_iterator it = v.begin(); it != v.end(); it++)
-                new_v.push_back(*it);
-            add_clause(new_v);
-
-            // ==== l <- \/ (vi) === !l -> ![ \/ (vi)]
-            //                   === !l -> /\ (!vi)
-            for (std::vector<int>::const_iterator it = v.begin(); it != v.end(); it++)
-                add_clause(l, -*it); // !l -> !vi === l \/ !vi
-        }
+        const int v[] = {id, ids...};
+        add_lits(v, sizeof(v) / sizeof(v[0]));
     }
 }
 
@@ -0,0 +1,195 @@
+/**
+ * File:   batchchecker.cpp
+ * Author: Yongkang Li
+ *
+ * Created on July 22, 2023, 10:20 AM
+ */
+
+#include "batchchecker.h"
+#include "ltlfchecker.h"
+#include "carchecker.h"
+#include "sweepsolver.h"
+#include <chrono>
+#include <thread>
+
+namespace aalta
+{
+    void prime_ids()
+    {
+        aalta_formula::TAIL(); // set tail id to be 1
+        aalta_formula(e_not, nullptr, aalta_formula::TAIL()).unique();
+        aalta_formula::FALSE(); // set FALSE id to be 2
+        aalta_formula::TRUE(); // set TRUE id to be 3
+        aalta_formula("a").unique();
+        aalta_formula(e_not, nullptr, aalta_formula("a").unique()).unique();
+        aalta_formula(e_next, nullptr, aalta_formula("a").unique()).unique();
+        aalta_formula("b").unique();
+        aalta_formula(e_not, nullptr, aalta_formula("b").unique()).unique();
+        aalta_formula(e_next, nullptr, aalta_formula("b").unique()).unique();
+    }
+
+    std::string engine_name(bool blsc, bool sweep)
+    {
+        const SatSolver::backend sat = SatSolver::get_default();
+        return std::string(blsc ? "blsc" : "car") + (sweep ? "+sweep" : "") + (Solver::polarity_encoding() ? "+pg" : "") +
+               (Solver::preprocessing() ? "+pre" : "") +
+               (sat != SatSolver::MINISAT ? std::string("+") + SatSolver::name_of(sat) : "");
+    }
+
+    BatchChecker::BatchChecker(int threads, bool blsc, bool sweep, FILE *out, af_cache *cache, long max_afs)
+        : threads_(threads < 1 ? 1 : threads), blsc_(blsc), sweep_(sweep), out_(out), cache_(cache), max_afs_(max_afs)
+    {
+        for (int w = 0; w < threads_; w++)
+            queues_.emplace_back(new queue());
+    }
+
+    void BatchChecker::run(af_reader &reader)
+    {
+        std::vector<std::thread> workers;
+        for (int w = 0; w < threads_; w++)
+            workers.emplace_back(&BatchChecker::work, this, w);
+
+        const char *in;
+        size_t len;
+        for (long index = 0; reader.next(in, len); index++)
+        {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                space_cv_.wait(lock, [&]
+                               { return index - next_out_ < MAX_IN_FLIGHT; });
+            }
+            queue &q = *queues_[index % threads_];
+            {
+                std::lock_guard<std::mutex> lock(q.mutex);
+                q.tasks.push_back({index, reader.line_no(), std::string(in, len)});
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                queued_++;
+            }
+            work_cv_.notify_one();
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            input_done_ = true;
+        }
+        work_cv_.notify_all();
+        for (std::thread &t : workers)
+            t.join();
+    }
+
+    void BatchChecker::work(int w)
+    {
+        af_context ctx;
+        af_context::scope use(ctx);
+        prime_ids();
+        task t;
+        while (take(w, t))
+        {
+            if ((long)aalta_formula::unique_size() > max_afs_)
+            {
+                ctx.reset();
+                prime_ids();
+                resets_++;
+            }
+            report(t.index, check(t));
+        }
+    }
+
+    // the oldest task of the own queue, or the newest one of another queue, false if there are no more
+    bool BatchChecker::take(int w, task &t)
+    {
+        for (;;)
+        {
+            for (int i = 0; i < threads_; i++)
+            {
+                queue &q = *queues_[(w + i) % threads_];
+                std::lock_guard<std::mutex> lock(q.mutex);
+                if (q.tasks.empty())
+                    continue;
+                if (i == 0)
+                {
+                    t = std::move(q.tasks.front());
+                    q.tasks.pop_front();
+                }
+                else
+                {
+                    t = std::move(q.tasks.back());
+                    q.tasks.pop_back();
+                }
+                std::lock_guard<std::mutex> count_lock(mutex_);
+                queued_--;
+                return true;
+            }
+            std::unique_lock<std::mutex> lock(mutex_);
+            work_cv_.wait(lock, [&]
+                          { return queued_ > 0 || input_done_; });
+            if (queued_ == 0)
+                return false;
+        }
+    }
+
+    // parse + normalize (+ cache lookup) (+ sweep) + check, like `main()` does for one formula
+    BatchChecker::result BatchChecker::check(const task &t) const
+    {
+        const auto start = std::chrono::steady_clock::now();
+        result r{t.line_no, false, 0, 0};
+        aalta_formula *af = aalta_formula(t.formula.data(), t.formula.size()).unique()->normalize();
+        af_fingerprint fp;
+        af_cache::entry cached;
+        if (cache_ != nullptr)
+        {
+            fp = af->fingerprint();
+            if (cache_->find(fp, cached))
+            {
+                r.sat = cached.sat;
+                r.sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                return r;
+            }
+        }
+        if (sweep_)
+        {
+            SweepSolver sweeper(af);
+            af = sweeper.sweep();
+            r.sat_calls += sweeper.sat_calls();
+        }
+        if (blsc_)
+        {
+            LTLfChecker checker(af);
+            r.sat = checker.check();
+            r.sat_calls += checker.sat_calls();
+        }
+        else
+        {
+            CARChecker checker(af);
+            r.sat = checker.check();
+            r.sat_calls += checker.sat_calls();
+        }
+        r.sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (cache_ != nullptr)
+        {
+            cached.sat = r.sat, cached.engine = engine_name(blsc_, sweep_);
+            cached.sec = r.sec, cached.sat_calls = r.sat_calls;
+            cache_->add(fp, cached);
+        }
+        return r;
+    }
+
+    void BatchChecker::report(long index, const result &r)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        done_[index] = r;
+        bool printed = false;
+        for (auto it = done_.begin(); it != done_.end() && it->first == next_out_; it = done_.erase(it), next_out_++)
+        {
+            fprintf(out_, "%ld %s %.6f %ld\n", it->second.line_no, it->second.sat ? "sat" : "unsat",
+                    it->second.sec, it->second.sat_calls);
+            printed = true;
+        }
+        if (printed)
+        {
+            fflush(out_);
+            space_cv_.notify_one();
+        }
+    }
+}
@@ -0,0 +1,112 @@
+/**
+ * File:   batchchecker.h
+ * Author: Yongkang Li
+ *
+ * Created on July 22, 2023, 10:20 AM
+ */
+
+#ifndef BATCH_CHECKER_H
+#define BATCH_CHECKER_H
+
+#include "formula/aalta_formula.h"
+#include "formula/af_cache.h"
+#include "formula/af_reader.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace aalta
+{
+    // the first afs of `main()`, so that e.g. Tail is id 1 (and the ids of a formula are the same as in a single run)
+    void prime_ids();
+    // the engine of the verdicts in `af_cache`, e.g. "car+sweep", "blsc+pg" (see `Solver::set_polarity_encoding()`),
+    // "car+pre" (see `Solver::set_preprocessing()`), "car+simp" (see `SatSolver::set_default()`)
+    std::string engine_name(bool blsc, bool sweep);
+
+    /**
+     * Checks the formulas of a batch (see `-batch`) on a pool of worker threads,
+     * and prints their result lines in the input order:
+     *      <line no.> <sat|unsat> <wall time in seconds> <SAT calls>
+     *
+     * - every worker has its own af_context (see `af_context::scope`), and builds its own checker (and solvers),
+     *   so the workers share nothing but the queues. The context of a worker is kept for its next formulas
+     *   (the unique afs and the atoms they share are found, not built again), and reset once it holds more than
+     *   \@max_afs afs, as the solvers take time and memory for all the ids of the context (see `Solver::reserve_vars()`)
+     * - every worker has its own queue, the formulas are given round-robin as they are read,
+     *   a worker takes the oldest formula of its own queue, and steals the newest one of another queue if it is empty,
+     *   so a long formula doesn't hold up the ones queued behind it
+     * - a result is printed (and flushed) as soon as all results before it are, at most MAX_IN_FLIGHT formulas are
+     *   read but not printed yet, so the memory is bounded even for an endless stream behind a long formula
+     * - with a \@cache, a formula whose normalized af is in it is not checked (its line has 0 SAT calls),
+     *   and the verdicts of the others are added to it (the caller saves it, see `af_cache::save()`)
+     */
+    class BatchChecker
+    {
+    public:
+        /**
+         * the default \@max_afs: after its check, a spec of a few dozen subformulas (e.g. an arbiter of 4-6 clients)
+         * leaves 150-700 afs in the context, a spec of a handful of subformulas 10-20,
+         * so a context holds the afs of tens to hundreds of specs, and a solver reserves ~1 MB for the ids
+         */
+        static const long DEFAULT_MAX_AFS = 1 << 14;
+
+        BatchChecker(int threads, bool blsc, bool sweep, FILE *out = stdout, af_cache *cache = nullptr,
+                     long max_afs = DEFAULT_MAX_AFS);
+        // check all formulas of \@reader
+        void run(af_reader &reader);
+        // how many times a worker has reset its context, see \@max_afs
+        inline long resets() const { return resets_; }
+
+    private:
+        static const long MAX_IN_FLIGHT = 1 << 12;
+
+        struct task
+        {
+            long index; // in the batch
+            long line_no;
+            std::string formula;
+        };
+        struct result
+        {
+            long line_no;
+            bool sat;
+            double sec;
+            long sat_calls;
+        };
+        struct queue
+        {
+            std::mutex mutex;
+            std::deque<task> tasks;
+        };
+
+        const int threads_;
+        const bool blsc_;
+        const bool sweep_;
+        FILE *out_;
+        af_cache *cache_;
+        const long max_afs_;
+        std::atomic<long> resets_{0};
+        std::vector<std::unique_ptr<queue>> queues_;
+
+        std::mutex mutex_;                  // guards the members below
+        std::condition_variable work_cv_;   // a task is queued, or the input is done
+        std::condition_variable space_cv_;  // a result is printed
+        long queued_ = 0;                   // tasks in the queues
+        bool input_done_ = false;
+        std::map<long, result> done_;       // results not printed yet, by index
+        long next_out_ = 0;                 // index of the next result to print
+
+        void work(int w);
+        bool take(int w, task &t);
+        result check(const task &t) const;
+        void report(long index, const result &r);
+    };
+}
+
+#endif
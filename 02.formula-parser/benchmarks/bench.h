@@ -0,0 +1,189 @@
+/**
+ * Helpers shared by the benchmarks: timer, memory usage and formula families.
+ *
+ * File:   bench.h
+ * Author: Yongkang Li
+ *
+ * Created on July 10, 2023, 15:02 PM
+ */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include "formula/aalta_formula.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+#include <sys/resource.h>
+
+namespace bench
+{
+    using aalta::aalta_formula;
+
+    class timer
+    {
+    public:
+        timer() : start_(std::chrono::steady_clock::now()) {}
+        void reset() { start_ = std::chrono::steady_clock::now(); }
+        // elapsed seconds
+        double elapsed() const
+        {
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+        }
+
+    private:
+        std::chrono::steady_clock::time_point start_;
+    };
+
+    // current resident memory in KB, read from /proc/self/status
+    inline long rss_kb()
+    {
+        FILE *fp = fopen("/proc/self/status", "r");
+        if (fp == NULL)
+            return -1;
+        char line[256];
+        long res = -1;
+        while (fgets(line, sizeof(line), fp) != NULL)
+            if (strncmp(line, "VmRSS:", 6) == 0)
+            {
+                res = atol(line + 6);
+                break;
+            }
+        fclose(fp);
+        return res;
+    }
+
+    // peak resident memory in KB
+    inline long peak_rss_kb()
+    {
+        struct rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        return usage.ru_maxrss;
+    }
+
+    inline aalta_formula *atom(const std::string &name)
+    {
+        return aalta_formula(name.c_str()).unique();
+    }
+
+    inline aalta_formula *make(int op, aalta_formula *l, aalta_formula *r)
+    {
+        return aalta_formula(op, l, r).unique();
+    }
+
+    /////////// formula families
+
+    // X X ... X a
+    inline aalta_formula *x_tower(int depth)
+    {
+        aalta_formula *res = atom("a");
+        for (int i = 0; i < depth; i++)
+            res = make(aalta::e_next, nullptr, res);
+        return res;
+    }
+
+    // a U (b U (a U ... ))
+    inline aalta_formula *until_chain(int depth)
+    {
+        aalta_formula *a = atom("a"), *b = atom("b");
+        aalta_formula *res = b;
+        for (int i = 0; i < depth; i++)
+            res = make(aalta::e_until, (i & 1) ? a : b, res);
+        return res;
+    }
+
+    // p0 & X p1 & p2 & X p3 ...
+    inline aalta_formula *wide_and(int width)
+    {
+        std::vector<aalta_formula *> ands;
+        for (int i = 0; i < width; i++)
+        {
+            aalta_formula *p = atom("p" + std::to_string(i));
+            ands.push_back((i & 1) ? make(aalta::e_next, nullptr, p) : p);
+        }
+        return aalta::formula_from(ands);
+    }
+
+    // l_{i+1} = X(l_i) U (l_i & X p_i), every level uses the one below twice, so the tree (not the DAG) is 2^depth large
+    inline aalta_formula *shared_ladder(int depth)
+    {
+        aalta_formula *res = atom("a");
+        for (int i = 0; i < depth; i++)
+        {
+            aalta_formula *p = make(aalta::e_next, nullptr, atom("p" + std::to_string(i)));
+            res = make(aalta::e_until, make(aalta::e_next, nullptr, res), make(aalta::e_and, res, p));
+        }
+        return res;
+    }
+
+    // a random DAG with \@ n operators over \@ atoms atoms, every operator takes earlier nodes as operands
+    inline aalta_formula *random_dag(int n, int atoms, unsigned seed)
+    {
+        static const int ops[] = {aalta::e_and, aalta::e_or, aalta::e_next, aalta::e_until, aalta::e_release};
+        srand(seed);
+        std::vector<aalta_formula *> pool;
+        for (int i = 0; i < atoms; i++)
+            pool.push_back(atom("q" + std::to_string(i)));
+        for (int i = 0; i < n; i++)
+        {
+            int op = ops[rand() % 5];
+            // prefer recent nodes, so that the DAG gets deep
+            aalta_formula *l = pool[pool.size() - 1 - rand() % std::min<size_t>(pool.size(), 16)];
+            aalta_formula *r = pool[rand() % pool.size()];
+            pool.push_back(op == aalta::e_next ? make(op, nullptr, l) : make(op, l, r));
+        }
+        return pool.back();
+    }
+
+    // a0 & /\ G (ai -> X (ai U ai+1)) (& G !an), in the input syntax
+    inline std::string chain_spec(int n, bool unsat)
+    {
+        std::string res = "a0";
+        for (int i = 0; i < n; i++)
+            res += " & G (a" + std::to_string(i) + " -> X (a" + std::to_string(i) + " U a" + std::to_string(i + 1) + "))";
+        return unsat ? res + " & G !a" + std::to_string(n) : res;
+    }
+
+    // the arbiter /\ G (ri -> X F gi) & F ri & /\ G (!gi | !gj) (& G !g0), in the input syntax
+    inline std::string arbiter_spec(int n, bool unsat)
+    {
+        std::string res = "true";
+        for (int i = 0; i < n; i++)
+        {
+            const std::string s = std::to_string(i);
+            res += " & G (r" + s + " -> X F g" + s + ") & F r" + s;
+            for (int j = i + 1; j < n; j++)
+                res += " & G (!g" + s + " | !g" + std::to_string(j) + ")";
+        }
+        return unsat ? res + " & G !g0" : res;
+    }
+
+    // a random spec in the input syntax, with all the operators of the parser, like the query of a user
+    inline std::string random_spec(int depth, const std::vector<std::string> &atoms, std::mt19937 &rng)
+    {
+        static const char *unary[] = {"!", "X", "N", "G", "F"};
+        static const char *binary[] = {"U", "R", "W", "&", "|", "->", "<->", "&", "|", "U"};
+        std::uniform_real_distribution<double> coin(0, 1);
+        if (depth == 0 || coin(rng) < 0.2)
+        {
+            const double r = coin(rng);
+            if (r < 0.05)
+                return "true";
+            if (r < 0.1)
+                return "false";
+            return atoms[rng() % atoms.size()];
+        }
+        const size_t op = rng() % 15;
+        if (op < 5)
+            return std::string(unary[op]) + "(" + random_spec(depth - 1, atoms, rng) + ")";
+        std::string l = random_spec(depth - 1, atoms, rng);
+        std::string r = random_spec(depth - 1, atoms, rng);
+        return "(" + l + ") " + binary[op - 5] + " (" + r + ")";
+    }
+}
+
+#endif
@@ -0,0 +1,100 @@
+/**
+ * The SAT backends (see `SatSolver`) against each other, on the whole checks of CAR and BLSC,
+ * and minisat/simp with the XNF clauses preprocessed ("pre", see `Solver::set_preprocessing()`).
+ *
+ * Usage: bench-sat [file]
+ *  - file: one formula per line (e.g. a corpus, which the checkers should finish), the families below by default
+ *  - families: the chains a0 & /\ G (ai -> X (ai U ai+1)) (& G !an), and the arbiters
+ *              /\ G (ri -> X F gi) & F ri & /\ G (!gi | !gj) (& G !g0), sat and unsat
+ * Every formula has its own af_context, and the same formulas are checked with every backend,
+ * so the SAT calls are the same (or not far off), and the time is the one of the SAT solver (and the encoding).
+ *
+ * File:   backends.cpp
+ * Author: Yongkang Li
+ *
+ * Created on July 26, 2023, 15:20 PM
+ */
+
+#include "benchmarks/bench.h"
+#include "carchecker.h"
+#include "ltlfchecker.h"
+#include "formula/af_reader.h"
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace aalta;
+
+int main(int argc, char **argv)
+{
+    std::vector<std::string> specs;
+    if (argc > 1)
+    {
+        af_reader reader(argv[1]);
+        const char *in;
+        size_t len;
+        while (reader.next(in, len))
+            if (len > 0)
+                specs.emplace_back(in, len);
+    }
+    else
+        for (bool unsat : {false, true})
+        {
+            for (int n = 4; n <= 16; n += 2)
+                specs.push_back(bench::chain_spec(n, unsat));
+            for (int n = 2; n <= 6; n++)
+                specs.push_back(bench::arbiter_spec(n, unsat));
+        }
+
+    std::vector<std::unique_ptr<af_context>> contexts;
+    std::vector<aalta_formula *> afs;
+    for (const std::string &s : specs)
+    {
+        contexts.emplace_back(new af_context());
+        af_context::scope use(*contexts.back());
+        afs.push_back(aalta_formula(s.c_str()).unique()->normalize());
+    }
+
+    for (bool blsc : {false, true})
+    {
+        std::vector<bool> verdicts;
+        for (int config = 0; config < 3; config++)
+        {
+            const SatSolver::backend b = config == 0 ? SatSolver::MINISAT : SatSolver::SIMP;
+            SatSolver::set_default(b);
+            Solver::set_preprocessing(config == 2);
+            long sat = 0, sat_calls = 0, differ = 0;
+            bench::timer t;
+            for (size_t i = 0; i < afs.size(); i++)
+            {
+                af_context::scope use(*contexts[i]);
+                bool res;
+                if (blsc)
+                {
+                    LTLfChecker checker(afs[i]);
+                    res = checker.check();
+                    sat_calls += checker.sat_calls();
+                }
+                else
+                {
+                    CARChecker checker(afs[i]);
+                    res = checker.check();
+                    sat_calls += checker.sat_calls();
+                }
+                sat += res;
+                if (verdicts.size() < afs.size())
+                    verdicts.push_back(res);
+                else
+                    differ += verdicts[i] != res;
+            }
+            const double sec = t.elapsed();
+            printf("%-4s %-7s %4zu formulas  %4ld sat  %8ld SAT calls  %.3f s  %8.0f SAT calls/s%s\n", blsc ? "blsc" : "car",
+                   config == 2 ? "pre" : SatSolver::name_of(b), afs.size(), sat, sat_calls, sec, sat_calls / sec,
+                   differ > 0 ? "  VERDICTS DIFFER" : "");
+        }
+    }
+    SatSolver::set_default(SatSolver::MINISAT);
+    Solver::set_preprocessing(false);
+    return 0;
+}
@@ -0,0 +1,79 @@
+/**
+ * Peak memory of a long batch of unrelated queries, like a checking service does.
+ *
+ * Usage: bench-batch-rss [n] [keep|reset]
+ *  - keep:  all queries share the global af_context, it only grows
+ *  - reset: every query gets its own af_context, dropped after the query
+ * Every query has its own atoms, so nothing is shared between queries anyway.
+ * A query is parse + normalize + XNF encoding + a few steps of the BLSC loop
+ * (bounded, as the random specs include ones the checkers don't finish).
+ * Run the two modes in two processes, as peak RSS is per process.
+ *
+ * File:   batch_rss.cpp
+ * Author: Yongkang Li
+ *
+ * Created on July 13, 2023, 11:10 AM
+ */
+
+#include "benchmarks/bench.h"
+#include "solver.h"
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace aalta;
+
+#define STEPS 8
+
+// return whether a finite model of at most STEPS steps is found
+static bool run_query(const std::string &spec)
+{
+    aalta_formula *af = aalta_formula(spec.c_str()).unique();
+    af = af->normalize();
+    Solver solver(af);
+    for (int step = 0; step < STEPS; step++)
+    {
+        if (solver.check_tail(af))
+            return true;
+        if (!solver.solve_by_assumption(af))
+            return false;
+        Transition *t = solver.get_transition();
+        af = t->next();
+        delete t;
+    }
+    return false;
+}
+
+int main(int argc, char **argv)
+{
+    const int n = argc > 1 ? atoi(argv[1]) : 10000;
+    const bool reset = argc > 2 && std::string(argv[2]) == "reset";
+
+    std::mt19937 rng(1);
+    int sat = 0;
+    long max_afs = 0;
+    const long rss0 = bench::rss_kb();
+    bench::timer t;
+    for (int i = 0; i < n; i++)
+    {
+        const std::string s = std::to_string(i);
+        const std::string spec = bench::random_spec(1 + rng() % 5, {"a" + s, "b" + s, "c" + s}, rng);
+        if (reset)
+        {
+            af_context ctx;
+            af_context::scope use(ctx);
+            sat += run_query(spec);
+            max_afs = std::max<long>(max_afs, aalta_formula::unique_size());
+        }
+        else
+        {
+            sat += run_query(spec);
+            max_afs = std::max<long>(max_afs, aalta_formula::unique_size());
+        }
+        if ((i + 1) % (n / 5 == 0 ? 1 : n / 5) == 0)
+            printf("%6d queries   rss %7ld KB   live afs %8d\n", i + 1, bench::rss_kb(), aalta_formula::unique_size());
+    }
+    printf("mode %-5s  n=%d  sat %d  time %.3f s  max afs %ld  rss +%ld KB  peak rss %ld KB\n",
+           reset ? "reset" : "keep", n, sat, t.elapsed(), max_afs, bench::rss_kb() - rss0, bench::peak_rss_kb());
+    return 0;
+}
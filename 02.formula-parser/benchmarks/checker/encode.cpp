@@ -0,0 +1,109 @@
+/**
+ * Throughput of the clause encoding: the clause API of AaltaSolver alone, and the XNF clauses of `Solver(af)`.
+ *
+ * Usage: bench-encode [rounds]
+ *  - clauses:  binary/ternary clauses and n-ary equivalences over random ids, like the frame and blocking clauses
+ *  - xnf:      `Solver(af)` of normalized formulas, i.e. `add_clauses_for()` + the X conflicts + the COI,
+ *              with the full and the polarity-aware encoding (see `Solver::set_polarity_encoding()`)
+ * Every round builds new solvers, so the time includes the growth of the vars and the clause database.
+ *
+ * File:   encode.cpp
+ * Author: Yongkang Li
+ *
+ * Created on July 24, 2023, 10:05 AM
+ */
+
+#include "benchmarks/bench.h"
+#include "solver.h"
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace aalta;
+
+#define VARS 20000
+#define CLAUSES 200000
+
+// random clauses over VARS ids, return the number of clauses added
+static long encode_clauses(unsigned seed)
+{
+    std::mt19937 rng(seed);
+    auto lit = [&]
+    { return int(1 + rng() % VARS) * ((rng() & 1) ? 1 : -1); };
+    AaltaSolver solver;
+    std::vector<int> ops;
+    long res = 0;
+    for (int i = 0; i < CLAUSES; i++)
+        switch (i % 4)
+        {
+        case 0:
+            solver.add_clause(lit(), lit());
+            res++;
+            break;
+        case 1:
+            solver.add_clause(lit(), lit(), lit());
+            res++;
+            break;
+        default: // l <-> /\ (vi) or \/ (vi), 2 ... 5 operands
+            ops.clear();
+            for (int n = 2 + rng() % 4; n > 0; n--)
+                ops.push_back(lit());
+            solver.add_equivalence_wise(i % 4 == 2, lit(), ops);
+            res += ops.size() + 1;
+            break;
+        }
+    return res;
+}
+
+int main(int argc, char **argv)
+{
+    const int rounds = argc > 1 ? atoi(argv[1]) : 10;
+
+    // === the clause API alone
+    {
+        long clauses = 0;
+        bench::timer t;
+        for (int r = 0; r < rounds; r++)
+            clauses += encode_clauses(r);
+        const double sec = t.elapsed();
+        printf("clauses  %9ld clauses  %.3f s  %6.2f M clauses/s\n", clauses, sec, clauses / sec / 1e6);
+    }
+
+    // === the XNF encoding of normalized formulas, each in its own context (as in a batch),
+    //     so that the vars are the ids of the formula, not of all formulas
+    std::vector<std::unique_ptr<af_context>> contexts;
+    std::vector<aalta_formula *> afs;
+    std::mt19937 rng(1);
+    for (int i = 0; i < 202; i++)
+    {
+        contexts.emplace_back(new af_context());
+        af_context::scope use(*contexts.back());
+        aalta_formula *af;
+        if (i == 200)
+            af = bench::random_dag(2000, 50, 7);
+        else if (i == 201)
+            af = bench::shared_ladder(1000);
+        else
+            af = aalta_formula(bench::random_spec(8, {"a", "b", "c", "d"}, rng).c_str()).unique();
+        afs.push_back(af->normalize());
+    }
+    for (bool polarity : {false, true})
+    {
+        Solver::set_polarity_encoding(polarity);
+        long clauses = 0, vars = 0;
+        bench::timer t;
+        for (int r = 0; r < rounds; r++)
+            for (size_t i = 0; i < afs.size(); i++)
+            {
+                af_context::scope use(*contexts[i]);
+                Solver solver(afs[i]);
+                clauses += solver.nClauses();
+                vars += solver.nVars();
+            }
+        const double sec = t.elapsed();
+        printf("xnf %-4s %9ld clauses  %9ld vars  %.3f s  %6.2f M clauses/s\n", polarity ? "pg" : "full", clauses, vars,
+               sec, clauses / sec / 1e6);
+    }
+    return 0;
+}
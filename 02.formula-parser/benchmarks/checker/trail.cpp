@@ -0,0 +1,181 @@
+/**
+ * SAT calls/s of the vendored minisat/core with and without the reuse of the trail between calls
+ * (see `Minisat::Solver::reuse_trail`), on the query sequences of CAR and BLSC.
+ *
+ * Usage: bench-trail [file]
+ *  - file: one formula per line, the chains and arbiters of bench.h (sat and unsat) by default
+ * The calls of every SatSolver of the checkers (the CARSolver, the InvSolvers, the Solver of BLSC) are recorded
+ * (see `SatSolver::set_wrapper()`), and then replayed on a new Minisat::Solver, once without and once with the reuse,
+ * so both run exactly the same clauses and assumptions. The results of the calls must be the same.
+ *
+ * File:   trail.cpp
+ * Author: Yongkang Li
+ *
+ * Created on July 28, 2023, 10:30 AM
+ */
+
+#include "benchmarks/bench.h"
+#include "carchecker.h"
+#include "ltlfchecker.h"
+#include "formula/af_reader.h"
+#include "minisat/core/Solver.h"
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace aalta;
+using Minisat::lbool; // of l_True
+
+/**
+ * the calls of a solver: a clause is `n l1 .. ln` (n > 0), a solve is `-(n+1) a1 .. an` (the n assumptions),
+ * the other calls don't change the clauses or the results
+ */
+typedef std::vector<int> trace;
+static std::vector<std::unique_ptr<trace>> traces;
+
+class recorder : public SatSolver
+{
+public:
+    explicit recorder(SatSolver *s) : s_(s), calls_(new trace()) {}
+    ~recorder() { traces.emplace_back(calls_); }
+
+    const char *name() const override { return s_->name(); }
+    void add(const int *lits, int n) override
+    {
+        calls_->push_back(n);
+        calls_->insert(calls_->end(), lits, lits + n);
+        s_->add(lits, n);
+    }
+    void assume(int lit) override
+    {
+        assumps_.push_back(lit);
+        s_->assume(lit);
+    }
+    result solve() override
+    {
+        calls_->push_back(-int(assumps_.size() + 1));
+        calls_->insert(calls_->end(), assumps_.begin(), assumps_.end());
+        assumps_.clear();
+        return s_->solve();
+    }
+    int val(int lit) const override { return s_->val(lit); }
+    void failed(std::vector<int> &res) const override { s_->failed(res); }
+    void interrupt() override { s_->interrupt(); }
+    int vars() const override { return s_->vars(); }
+    int clauses() const override { return s_->clauses(); }
+    void reserve(int n) override { s_->reserve(n); }
+    void freeze(int lit) override { s_->freeze(lit); }
+    bool preprocess() override { return s_->preprocess(); }
+    int eliminated() const override { return s_->eliminated(); }
+
+private:
+    std::unique_ptr<SatSolver> s_;
+    trace *calls_; // moved into `traces` when the solver is gone
+    std::vector<int> assumps_;
+};
+
+static SatSolver *record(SatSolver *s) { return new recorder(s); }
+
+struct replay_stats
+{
+    long calls = 0, sat = 0;
+    uint64_t propagations = 0, decisions = 0, reused_levels = 0, assumptions = 0;
+    std::vector<char> results;
+};
+
+static void replay(const trace &t, bool reuse, replay_stats &res)
+{
+    Minisat::Solver s;
+    s.reuse_trail = reuse;
+    Minisat::vec<Minisat::Lit> lits;
+    auto lit = [&s](int id)
+    {
+        const int var = abs(id) - 1;
+        while (s.nVars() <= var)
+            s.newVar();
+        return id > 0 ? Minisat::mkLit(var) : ~Minisat::mkLit(var);
+    };
+    for (size_t i = 0; i < t.size();)
+    {
+        const int n = t[i] > 0 ? t[i] : -t[i] - 1;
+        lits.clear();
+        for (int k = 1; k <= n; k++)
+            lits.push(lit(t[i + k]));
+        if (t[i] > 0)
+            s.addClause_(lits);
+        else
+        {
+            const bool sat = s.solveLimited(lits) == l_True;
+            res.calls++;
+            res.sat += sat;
+            res.assumptions += n;
+            res.results.push_back(sat);
+        }
+        i += n + 1;
+    }
+    res.propagations += s.propagations;
+    res.decisions += s.decisions;
+    res.reused_levels += s.reused_levels;
+}
+
+int main(int argc, char **argv)
+{
+    std::vector<std::string> specs;
+    if (argc > 1)
+    {
+        af_reader reader(argv[1]);
+        const char *in;
+        size_t len;
+        while (reader.next(in, len))
+            if (len > 0)
+                specs.emplace_back(in, len);
+    }
+    else
+        for (bool unsat : {false, true})
+        {
+            for (int n = 4; n <= 16; n += 2)
+                specs.push_back(bench::chain_spec(n, unsat));
+            for (int n = 2; n <= 6; n++)
+                specs.push_back(bench::arbiter_spec(n, unsat));
+        }
+
+    for (bool blsc : {false, true})
+    {
+        // === record
+        traces.clear();
+        SatSolver::set_wrapper(record);
+        for (const std::string &s : specs)
+        {
+            af_context ctx;
+            af_context::scope use(ctx);
+            aalta_formula *af = aalta_formula(s.c_str()).unique()->normalize();
+            if (blsc)
+                LTLfChecker(af).check();
+            else
+                CARChecker(af).check();
+        }
+        SatSolver::set_wrapper(nullptr);
+
+        // === replay
+        replay_stats without;
+        for (bool reuse : {false, true})
+        {
+            replay_stats stats;
+            bench::timer t;
+            for (const auto &calls : traces)
+                replay(*calls, reuse, stats);
+            const double sec = t.elapsed();
+            const bool differ = reuse && stats.results != without.results;
+            printf("%-4s reuse %-3s %4zu solvers  %8ld SAT calls (%ld sat)  %.3f s  %8.0f SAT calls/s  "
+                   "%10lu props  %8lu decisions  %5.1f%% of the assumption levels reused%s\n",
+                   blsc ? "blsc" : "car", reuse ? "on" : "off", traces.size(), stats.calls, stats.sat, sec, stats.calls / sec,
+                   (unsigned long)stats.propagations, (unsigned long)stats.decisions,
+                   stats.assumptions > 0 ? 100.0 * stats.reused_levels / stats.assumptions : 0.0,
+                   differ ? "  RESULTS DIFFER" : "");
+            if (!reuse)
+                without = std::move(stats);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,78 @@
+/**
+ * Build/traversal time and memory of the unique afs.
+ *
+ * `make bench-af-arena` builds it with the slab store (`nodes_`),
+ * `make bench-af-arena-heap` builds it with the old layout (one `new` per af).
+ *
+ * File:   arena.cpp
+ * Author: Yongkang Li
+ *
+ * Created on July 10, 2023, 15:30 PM
+ */
+
+#include "benchmarks/bench.h"
+#include <iostream>
+#include <vector>
+
+using namespace aalta;
+
+// visit every unique af reachable from \@ root once, \@ seen is indexed by af id
+static long traverse(aalta_formula *root, std::vector<char> &seen)
+{
+    long sum = 0;
+    std::vector<aalta_formula *> stack{root};
+    std::fill(seen.begin(), seen.end(), 0);
+    while (!stack.empty())
+    {
+        aalta_formula *f = stack.back();
+        stack.pop_back();
+        if (f == nullptr || seen[f->id()])
+            continue;
+        seen[f->id()] = 1;
+        sum += f->oper();
+        stack.push_back(f->l_af());
+        stack.push_back(f->r_af());
+    }
+    return sum;
+}
+
+static aalta_formula *dag(int n) { return bench::random_dag(n, 32, 2023); }
+
+static void run(const char *name, aalta_formula *(*family)(int), int n, int rounds)
+{
+    long rss_before = bench::rss_kb();
+    bench::timer t;
+    aalta_formula *f = family(n);
+    double build_s = t.elapsed();
+    long rss_after = bench::rss_kb();
+
+    std::vector<char> seen(aalta_formula::unique_size() + 1);
+    long check = 0;
+    t.reset();
+    for (int i = 0; i < rounds; i++)
+        check += traverse(f, seen);
+    double traverse_s = t.elapsed();
+
+    printf("%-12s n=%-8d build %8.3f ms   traverse %8.3f ms/round   rss +%6ld KB   (%ld)\n",
+           name, n, build_s * 1e3, traverse_s * 1e3 / rounds, rss_after - rss_before, check);
+}
+
+int main(int argc, char **argv)
+{
+    int scale = argc > 1 ? atoi(argv[1]) : 1;
+#ifdef AF_HEAP_NODES
+    puts("=== layout: heap (one `new` per af)");
+#else
+    puts("=== layout: slab arena");
+#endif
+    printf("sizeof(aalta_formula) = %zu\n", sizeof(aalta_formula));
+    aalta_formula::TRUE(), aalta_formula::FALSE(), aalta_formula::TAIL();
+
+    run("x_tower", bench::x_tower, 20000 * scale, 50);
+    run("until_chain", bench::until_chain, 20000 * scale, 50);
+    run("wide_and", bench::wide_and, 20000 * scale, 50);
+    run("random_dag", dag, 500000 * scale, 20);
+
+    printf("unique afs: %d   peak rss: %ld KB\n", aalta_formula::unique_size(), bench::peak_rss_kb());
+    return 0;
+}
@@ -0,0 +1,77 @@
+/**
+ * Throughput of parsing the input + building the unique afs (`aalta_formula(input).unique()`),
+ * on specs full of the derived operators (W, ->, <->, N, !X) and on random specs.
+ *
+ * Usage: bench-af-build [depth]
+ * Every run gets its own af_context, so no af is there beforehand.
+ *
+ * File:   build.cpp
+ * Author: Yongkang Li
+ *
+ * Created on July 18, 2023, 09:30 AM
+ */
+
+#include "benchmarks/bench.h"
+#include <iostream>
+
+using namespace aalta;
+
+// p0 <-> (p1 <-> (... <-> pn)), both operands of every <-> are needed in both polarities
+static std::string equiv_chain(int n)
+{
+    std::string res = "p" + std::to_string(n);
+    for (int i = n - 1; i >= 0; i--)
+        res = "p" + std::to_string(i) + " <-> (" + res + ")";
+    return res;
+}
+
+// ((p0 W p1) W p2) W ..., the left operand of every W is used twice
+static std::string wuntil_chain(int n)
+{
+    std::string res = "p0";
+    for (int i = 1; i <= n; i++)
+        res = "(" + res + ") W p" + std::to_string(i);
+    return res;
+}
+
+// !(X (p0 -> N (p1 -> X (...))))
+static std::string next_chain(int n)
+{
+    std::string res = "p" + std::to_string(n);
+    for (int i = n - 1; i >= 0; i--)
+        res = std::string(i & 1 ? "N" : "X") + " (p" + std::to_string(i) + " -> " + res + ")";
+    return "!(" + res + ")";
+}
+
+static void run(const char *name, const std::vector<std::string> &specs)
+{
+    af_context ctx;
+    af_context::scope use(ctx);
+    size_t chars = 0;
+    for (const std::string &s : specs)
+        chars += s.size();
+    bench::timer t;
+    long sum = 0;
+    for (const std::string &s : specs)
+        sum += aalta_formula(s.c_str()).unique()->id();
+    const double sec = t.elapsed();
+    printf("%-14s specs %6zu  chars %9zu  %9.4f s  %10.0f specs/s  afs %8d  (%ld)\n",
+           name, specs.size(), chars, sec, specs.size() / sec, aalta_formula::unique_size(), sum);
+}
+
+int main(int argc, char **argv)
+{
+    const int depth = argc > 1 ? atoi(argv[1]) : 18;
+
+    run("equiv_chain", {equiv_chain(depth)});
+    run("wuntil_chain", {wuntil_chain(depth)});
+    run("next_chain", std::vector<std::string>(1000, next_chain(200)));
+
+    std::mt19937 rng(2023);
+    const std::vector<std::string> atoms = {"a", "b", "c", "d", "e"};
+    std::vector<std::string> random;
+    for (int i = 0; i < 20000; i++)
+        random.push_back(bench::random_spec(6, atoms, rng));
+    run("random_spec", random);
+    return 0;
+}
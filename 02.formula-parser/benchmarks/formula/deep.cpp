@@ -0,0 +1,67 @@
+/**
+ * Scaling of the traversals on deep afs (nesting depth 10^3 .. 10^6), which used to be recursive:
+ * build() from an ltl_formula, split_next(), add_tail(), simplify(), normalize() and to_string().
+ *
+ * Usage: bench-af-deep [max depth]
+ * Every depth gets its own af_context, so nothing is memoized beforehand.
+ *
+ * File:   deep.cpp
+ * Author: Yongkang Li
+ *
+ * Created on July 19, 2023, 14:10 PM
+ */
+
+#include "benchmarks/bench.h"
+#include <iostream>
+
+using namespace aalta;
+
+// X N X N ... (a & b), as the parser would give it (the parser itself can't read such deep input)
+static ltl_formula *next_ltl(int depth)
+{
+    ltl_formula *res = create_operation(eAND, create_var("a"), create_var("b"));
+    for (int i = 0; i < depth; i++)
+        res = create_operation(i & 1 ? eNEXT : eWNEXT, NULL, res);
+    return res;
+}
+
+static void run(int depth)
+{
+    af_context ctx;
+    af_context::scope use(ctx);
+    ltl_formula *ltl = next_ltl(depth);
+    bench::timer t;
+    aalta_formula *xs = aalta_formula(ltl, false).unique();
+    const double t_build = t.elapsed();
+    destroy_formula(ltl);
+
+    t.reset();
+    aalta_formula *split = xs->split_next();
+    const double t_split = t.elapsed();
+    t.reset();
+    aalta_formula *tail = split->add_tail();
+    const double t_tail = t.elapsed();
+    t.reset();
+    tail->simplify();
+    const double t_simp = t.elapsed();
+
+    aalta_formula *us = bench::until_chain(depth);
+    t.reset();
+    us->normalize();
+    const double t_norm = t.elapsed();
+    t.reset();
+    const size_t len = us->to_string().size();
+    const double t_str = t.elapsed();
+
+    printf("depth %-8d build %8.4f  split_next %8.4f  add_tail %8.4f  simplify %8.4f  normalize %8.4f  to_string %8.4f s"
+           "   afs %9d  chars %zu\n",
+           depth, t_build, t_split, t_tail, t_simp, t_norm, t_str, aalta_formula::unique_size(), len);
+}
+
+int main(int argc, char **argv)
+{
+    const int max_depth = argc > 1 ? atoi(argv[1]) : 1000000;
+    for (int depth = 1000; depth <= max_depth; depth *= 10)
+        run(depth);
+    return 0;
+}
@@ -0,0 +1,80 @@
+/**
+ * Report the statistics of the unique table on a spec corpus,
+ * and the number of hash collisions of the old shift-xor hash and the current hash.
+ *
+ * usage: bench-af-hash [file ...]   (one formula per line, the formula families if no file is given)
+ *
+ * File:   hash_stats.cpp
+ * Author: Yongkang Li
+ *
+ * Created on July 11, 2023, 16:40 PM
+ */
+
+#include "benchmarks/bench.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace aalta;
+
+// the hash used before, kept here for comparison
+static size_t old_hash(aalta_formula *f, std::vector<size_t> &memo)
+{
+    if (memo[f->id()] != 0)
+        return memo[f->id()];
+    size_t h = 1315423911;
+    h = (h << 5) ^ (h >> 27) ^ f->oper();
+    if (f->l_af() != NULL)
+        h = (h << 5) ^ (h >> 27) ^ old_hash(f->l_af(), memo);
+    if (f->r_af() != NULL)
+        h = (h << 5) ^ (h >> 27) ^ old_hash(f->r_af(), memo);
+    h = (h << 5) ^ (h >> 27);
+    return memo[f->id()] = h;
+}
+
+// number of afs whose hash is shared with another af
+static size_t collisions(std::vector<size_t> hashes)
+{
+    std::sort(hashes.begin(), hashes.end());
+    size_t res = 0;
+    for (size_t i = 0; i < hashes.size(); i++)
+        if ((i > 0 && hashes[i] == hashes[i - 1]) || (i + 1 < hashes.size() && hashes[i] == hashes[i + 1]))
+            res++;
+    return res;
+}
+
+int main(int argc, char **argv)
+{
+    aalta_formula::TRUE(), aalta_formula::FALSE(), aalta_formula::TAIL();
+    if (argc == 1)
+    {
+        bench::x_tower(20000);
+        bench::until_chain(20000);
+        bench::wide_and(20000);
+        bench::random_dag(100000, 32, 2023);
+    }
+    for (int i = 1; i < argc; i++)
+    {
+        std::ifstream in(argv[i]);
+        std::string line;
+        while (std::getline(in, line))
+            if (!line.empty())
+                aalta_formula(line.c_str()).unique();
+    }
+
+    const int n = aalta_formula::unique_size();
+    std::vector<size_t> memo(n + 1, 0), old_hashes, new_hashes;
+    for (int id = 1; id <= n; id++)
+    {
+        aalta_formula *f = aalta_formula::get_af_by_id(id);
+        old_hashes.push_back(old_hash(f, memo));
+        new_hashes.push_back(aalta_formula::af_hash()(*f));
+    }
+    printf("unique afs: %d\n", n);
+    printf("afs sharing a 64-bit hash: old shift-xor %zu, current %zu\n", collisions(old_hashes), collisions(new_hashes));
+    puts("=== unique table");
+    aalta_formula::print_table_stats(std::cout);
+    return 0;
+}
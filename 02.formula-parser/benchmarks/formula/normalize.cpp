@@ -0,0 +1,59 @@
+/**
+ * Time of the normalization of the input of the checkers:
+ * `split_next()` + `add_tail()` + `simplify()` one after another vs. the fused `normalize()`.
+ *
+ * Usage: bench-af-normalize [depth]
+ * Every run gets its own af_context, so nothing is memoized beforehand.
+ *
+ * File:   normalize.cpp
+ * Author: Yongkang Li
+ *
+ * Created on July 14, 2023, 10:20 AM
+ */
+
+#include "benchmarks/bench.h"
+#include <iostream>
+
+using namespace aalta;
+
+static aalta_formula *dag(int n) { return bench::random_dag(n, 32, 2023); }
+
+static aalta_formula *three_passes(aalta_formula *f) { return f->split_next()->add_tail()->simplify(); }
+static aalta_formula *fused(aalta_formula *f) { return f->normalize(); }
+
+static void run(const char *name, aalta_formula *(*family)(int), int n,
+                const char *how, aalta_formula *(*normalize)(aalta_formula *))
+{
+    af_context ctx;
+    af_context::scope use(ctx);
+    aalta_formula *f = family(n);
+    const int before = aalta_formula::unique_size();
+    bench::timer t;
+    aalta_formula *res = normalize(f);
+    const double s = t.elapsed();
+    printf("%-14s n=%-7d %-12s %9.4f s   afs %8d -> %8d   result id %d\n",
+           name, n, how, s, before, aalta_formula::unique_size(), res->id());
+}
+
+int main(int argc, char **argv)
+{
+    const int depth = argc > 1 ? atoi(argv[1]) : 24;
+    struct
+    {
+        const char *name;
+        aalta_formula *(*family)(int);
+        int n;
+    } families[] = {
+        {"shared_ladder", bench::shared_ladder, depth},
+        {"x_tower", bench::x_tower, 2000},
+        {"until_chain", bench::until_chain, 2000},
+        {"wide_and", bench::wide_and, 20000},
+        {"random_dag", dag, 200000},
+    };
+    for (auto &fam : families)
+    {
+        run(fam.name, fam.family, fam.n, "3 passes", three_passes);
+        run(fam.name, fam.family, fam.n, "normalize", fused);
+    }
+    return 0;
+}
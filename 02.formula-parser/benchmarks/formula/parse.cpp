@@ -0,0 +1,107 @@
+/**
+ * Parse throughput of `af_parser` against the flex/bison `getAST()`,
+ * alone (+ `destroy_formula()` for getAST) and with the unique afs built (`aalta_formula(input).unique()` before/now).
+ *
+ * Usage: bench-af-parse [specs]
+ * Every run of the afs gets its own af_context, so no af is there beforehand.
+ *
+ * File:   parse.cpp
+ * Author: Yongkang Li
+ *
+ * Created on July 20, 2023, 15:40 PM
+ */
+
+#include "benchmarks/bench.h"
+#include "formula/af_parser.h"
+#include "ltlparser/trans.h"
+#include <iostream>
+
+using namespace aalta;
+
+static size_t chars_of(const std::vector<std::string> &specs)
+{
+    size_t chars = 0;
+    for (const std::string &s : specs)
+        chars += s.size();
+    return chars;
+}
+
+static void report(const char *name, const std::vector<std::string> &specs, double sec, long sum)
+{
+    printf("  %-22s %9.4f s  %10.0f specs/s  %8.1f MB/s  (%ld)\n",
+           name, sec, specs.size() / sec, chars_of(specs) / sec / 1e6, sum);
+}
+
+static void run(const char *name, const std::vector<std::string> &specs)
+{
+    printf("%s: specs %zu, chars %zu\n", name, specs.size(), chars_of(specs));
+    long sum = 0;
+    {
+        bench::timer t;
+        for (const std::string &s : specs)
+        {
+            ltl_formula *ast = getAST(s.c_str());
+            sum += ast->_type;
+            destroy_formula(ast);
+        }
+        report("getAST", specs, t.elapsed(), sum);
+    }
+    sum = 0;
+    {
+        af_parser parser;
+        bench::timer t;
+        for (const std::string &s : specs)
+            sum += parser.parse(s.c_str())->_type;
+        report("af_parser", specs, t.elapsed(), sum);
+    }
+    sum = 0;
+    {
+        af_context ctx;
+        af_context::scope use(ctx);
+        bench::timer t;
+        for (const std::string &s : specs)
+        {
+            ltl_formula *ast = getAST(s.c_str());
+            sum += aalta_formula(ast, false).unique()->id();
+            destroy_formula(ast);
+        }
+        report("getAST + build", specs, t.elapsed(), sum);
+    }
+    sum = 0;
+    {
+        af_context ctx;
+        af_context::scope use(ctx);
+        bench::timer t;
+        for (const std::string &s : specs)
+            sum += aalta_formula(s.c_str()).unique()->id();
+        report("aalta_formula(input)", specs, t.elapsed(), sum);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    const int n = argc > 1 ? atoi(argv[1]) : 20000;
+    std::mt19937 rng(2023);
+
+    // small queries, like the lines of a batch
+    const std::vector<std::string> atoms = {"a", "b", "c", "d", "e"};
+    std::vector<std::string> small;
+    for (int i = 0; i < n; i++)
+        small.push_back(bench::random_spec(6, atoms, rng));
+    run("random_spec", small);
+
+    // large specs: conjunctions of 500 random clauses over 100 atoms with long names
+    std::vector<std::string> names;
+    for (int i = 0; i < 100; i++)
+        names.push_back("signal_" + std::to_string(i));
+    std::vector<std::string> large;
+    for (int i = 0; i < n / 500; i++)
+    {
+        std::string s = "(" + bench::random_spec(4, names, rng) + ")";
+        for (int k = 1; k < 500; k++)
+            s += " && (" + bench::random_spec(4, names, rng) + ")";
+        large.push_back(s);
+    }
+    run("large_spec", large);
+    return 0;
+}
@@ -0,0 +1,84 @@
+/**
+ * Insert/lookup throughput of the unique table (af_table)
+ * against the old std::unordered_set version (afp_set).
+ *
+ * File:   unique_table.cpp
+ * Author: Yongkang Li
+ *
+ * Created on July 11, 2023, 11:20 AM
+ */
+
+#include "benchmarks/bench.h"
+#include <vector>
+
+using namespace aalta;
+
+static const int ROUNDS = 5;
+
+static void run(const char *name, aalta_formula *(*family)(int), int n)
+{
+    int first = aalta_formula::unique_size() + 1;
+    family(n);
+    int last = aalta_formula::unique_size();
+
+    // the unique afs of the family, and a non-unique copy of each, as `unique()` sees it
+    std::vector<aalta_formula *> afs;
+    std::vector<aalta_formula> temps;
+    for (int id = first; id <= last; id++)
+    {
+        aalta_formula *f = aalta_formula::get_af_by_id(id);
+        afs.push_back(f);
+        temps.push_back(aalta_formula(f->oper(), f->l_af(), f->r_af()));
+    }
+    std::vector<af_table::key> keys;
+    std::vector<size_t> hashes;
+    for (auto f : afs)
+    {
+        keys.push_back({f->oper(), f->l_af() == nullptr ? 0u : (af_handle)f->l_af()->id(),
+                        f->r_af() == nullptr ? 0u : (af_handle)f->r_af()->id()});
+        hashes.push_back(aalta_formula::af_hash()(*f));
+    }
+
+    double flat_ins = 0, flat_find = 0, set_ins = 0, set_find = 0;
+    long check = 0;
+    for (int round = 0; round < ROUNDS; round++)
+    {
+        af_table table;
+        bench::timer t;
+        for (size_t i = 0; i < keys.size(); i++)
+            table.insert(keys[i], hashes[i], afs[i]->id());
+        flat_ins += t.elapsed();
+        t.reset();
+        for (size_t i = 0; i < keys.size(); i++)
+            check += table.find(keys[i], hashes[i]);
+        flat_find += t.elapsed();
+
+        aalta_formula::afp_set set;
+        t.reset();
+        for (size_t i = 0; i < afs.size(); i++)
+            set.insert(afs[i]);
+        set_ins += t.elapsed();
+        t.reset();
+        for (size_t i = 0; i < temps.size(); i++)
+            check += (*set.find(&temps[i]))->id();
+        set_find += t.elapsed();
+    }
+
+    const double m = double(afs.size()) * ROUNDS / 1e6;
+    printf("%-12s %8zu afs | af_table: insert %7.2f M/s  find %7.2f M/s | unordered_set: insert %7.2f M/s  find %7.2f M/s  (%ld)\n",
+           name, afs.size(), m / flat_ins, m / flat_find, m / set_ins, m / set_find, check);
+}
+
+static aalta_formula *dag(int n) { return bench::random_dag(n, 64, 2023); }
+
+int main(int argc, char **argv)
+{
+    int scale = argc > 1 ? atoi(argv[1]) : 1;
+    aalta_formula::TRUE(), aalta_formula::FALSE(), aalta_formula::TAIL();
+
+    run("x_tower", bench::x_tower, 50000 * scale);
+    run("until_chain", bench::until_chain, 50000 * scale);
+    run("wide_and", bench::wide_and, 200000 * scale);
+    run("random_dag", dag, 1000000 * scale);
+    return 0;
+}
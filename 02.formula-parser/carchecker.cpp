@@ -9,10 +9,16 @@
 #include "myhjson.h"
 #include <iostream>
 using namespace std;
-using namespace Minisat;
 
 namespace aalta
 {
+    CARChecker::~CARChecker()
+    {
+        delete carsolver_;
+        for (Hjson::Value *hjson_ : hjson_transitions_)
+            delete hjson_;
+    }
+
     bool CARChecker::check()
     {
         if (to_check_->oper() == e_true)
@@ -22,6 +28,18 @@ namespace aalta
         return car_check(to_check_);
     }
 
+    void CARChecker::print_stats(std::ostream &os) const
+    {
+        os << "unique afs:  " << aalta_formula::unique_size() << std::endl
+           << "SAT vars:    " << carsolver_->nVars() << std::endl
+           << "XNF clauses: " << carsolver_->xnf_clauses() << std::endl
+           << "SAT calls:   " << sat_calls() << std::endl
+           << "try_satisfy: " << n_try_satisfy_ << std::endl
+           << "frames:      " << frames_.size() << std::endl;
+        if (Solver::preprocessing())
+            os << "eliminated:  " << carsolver_->nEliminated() << std::endl; // vars, see `Solver::set_preprocessing()`
+    }
+
     void CARChecker::record_transition(aalta_formula *f, Transition *t, int frame_level)
     {
         Hjson::Value *hjson_ = make_hjson(t);
@@ -82,18 +100,24 @@ namespace aalta
         // check whether \@f has a next state that can block constraints at level \@frame_level
         while (carsolver_->solve_with_assumption(f, frame_level))
         {
+            n_try_satisfy_++;
             Transition *t = carsolver_->get_transition();
+#ifdef DEBUG
             // add to graph
             record_transition(f, t, frame_level);
+#endif
 
+            bool found;
             if (frame_level == 0)
             {
-                if (sat_once(t->next()))
-                    return true;
-                else
+                found = sat_once(t->next());
+                if (!found)
                     add_frame_element(frame_level);
             }
-            else if (try_satisfy(t->next(), frame_level - 1))
+            else
+                found = try_satisfy(t->next(), frame_level - 1);
+            delete t; // NOTE: the Transition is not kept anywhere, only its afs (which belong to the af_context)
+            if (found)
                 return true;
         }
         add_frame_element(frame_level + 1);
@@ -108,11 +132,14 @@ namespace aalta
     {
         std::vector<int> uc = carsolver_->get_selected_uc(); // has invoked sat_once(f) before, so uc has been generated
 
+#ifdef DEBUG
         Hjson::Value *hjson_ptr = new Hjson::Value();
         (*hjson_ptr)["uc_af_s"] = aalta_formula::to_set_string(carsolver_->to_afs(uc));
         (*hjson_ptr)["flag"] = "add_frame_element";
         (*hjson_ptr)["frame_level"] = frame_level;
         print_hjson(hjson_ptr);
+        delete hjson_ptr;
+#endif
         
         assert(!uc.empty());
         if (frame_level == frames_.size())
@@ -133,6 +160,7 @@ namespace aalta
         int cur_frame_level = 0;
         while (cur_frame_level < frames_.size() && !res)
             res = inv_found_at(cur_frame_level++);
+        n_inv_sat_calls_ += inv_solver_->solves;
         delete inv_solver_;
         return res;
     }
@@ -183,6 +211,7 @@ namespace aalta
     bool CARChecker::sat_once(aalta_formula *f)
     {
         bool ret = carsolver_->check_final(f);
+#ifdef DEBUG
         if(ret) // model is not empty, only when SAT
         {
             // cur: f
@@ -194,7 +223,10 @@ namespace aalta
             (*hjson_)["cur"] = f->to_set_string();
             (*hjson_)["flag"] = "sat_once";
             print_hjson(hjson_);
+            delete hjson_;
+            delete t;
         }
+#endif
         return ret;
     }
 }
\ No newline at end of file
@@ -13,6 +13,7 @@
 #include "invsolver.h"
 #include "formula/aalta_formula.h"
 #include "myhjson.h"
+#include <ostream>
 #include <vector>
 
 namespace aalta
@@ -20,12 +21,16 @@ namespace aalta
     class CARChecker
     {
     public:
-        CARChecker(aalta_formula *f, bool verbose = false) : to_check_(f) {
+        CARChecker(aalta_formula *f, bool verbose = false) : to_check_(f), inv_solver_(nullptr), n_try_satisfy_(0), n_inv_sat_calls_(0) {
             carsolver_ = new CARSolver(f);
         }
-        ~CARChecker() {}
+        ~CARChecker();
 
         bool check();
+        // print the size of the search, i.e. unique afs, SAT vars and `try_satisfy()` iterations, see `-stats`
+        void print_stats(std::ostream &os) const;
+        // SAT calls of `check()` so far, the ones of the invariant solvers included
+        inline long sat_calls() const { return carsolver_->solves + n_inv_sat_calls_; }
         std::vector<Hjson::Value *> hjson_transitions_;
         void record_transition(aalta_formula *f, Transition *t, int frame_level);
 
@@ -37,6 +42,8 @@ namespace aalta
         Frame tmp_frame_;           // temporal frame to store the UCs before it is pushed into frames_
         CARSolver *carsolver_;
         InvSolver *inv_solver_;     // SAT solver to check invariant
+        long n_try_satisfy_;        // number of the states tried in `try_satisfy()`, i.e. its loop iterations
+        long n_inv_sat_calls_;      // SAT calls of the (already deleted) `inv_solver_`s
 
         // functions
         // main checking function
@@ -25,14 +25,16 @@ namespace aalta
         assert(!unsat_forever_);
         set_selected_assumption(f);
         
+#ifdef DEBUG
         // selected_assumption
         for(auto fid:selected_assumption_)
         {
             dout << aalta_formula::get_af_by_SAT_id(fid)->to_string() << std::endl;
         }
+#endif
 
         get_assumption_from(f, false);  // f = φ
-        assumption_.push(id_to_lit(frame_flags_[frame_level])); // ψ = C[frame level] = ! /\ X(uc[i])
+        assumption_.push_back(frame_flags_[frame_level]); // ψ = C[frame level] = ! /\ X(uc[i])
         return solve_assumption(); // ψ ∧ xnf(φ)
     }
 
@@ -96,8 +98,9 @@ namespace aalta
     void CARSolver::set_selected_assumption(aalta_formula *f)
     {
         selected_assumption_.clear();
-        af_prt_set ands = f->to_set();
-        for (af_prt_set::iterator it = ands.begin(); it != ands.end(); it++)
-            selected_assumption_.insert(get_SAT_id(*it));
+        if (f->oper() != e_and)
+            selected_assumption_.insert(get_SAT_id(f));
+        for (int i = 0; i < f->n_ops() && f->oper() == e_and; i++)
+            selected_assumption_.insert(get_SAT_id(f->operand(i)));
     }
 }
\ No newline at end of file
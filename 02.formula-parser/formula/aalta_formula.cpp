@@ -6,7 +6,9 @@
  */
 
 #include "formula/aalta_formula.h"
-#include "ltlparser/trans.h"
+#include "formula/af_parser.h"
+#include <algorithm>
+#include <cassert>
 #include <unordered_map>
 #include <map>
 #include <unordered_set>
@@ -14,6 +16,58 @@
 
 namespace aalta
 {
+    namespace
+    {
+        /**
+         * the explicit-stack post-order walk of the memoized transforms (e.g. `simplify()`),
+         * so that deep afs (e.g. 10^6 nested X) don't overflow the call stack:
+         * `step(f)` is called once for every af reachable by `dep()` from \@root which is not `done()` yet,
+         * after all of its deps are done, and it must make f done.
+         * So `step(f)` can still call the transform on its deps, which just returns the memo.
+         * `dep(f, i)` is the i-th dep of f (nullptr after the last one), it is asked for only after the (i-1)-th is done,
+         * so the new afs are created in the same order as by the recursion.
+         */
+        template <typename Done, typename Dep, typename Step>
+        void post_order(aalta_formula *root, Done done, Dep dep, Step step)
+        {
+            std::vector<std::pair<aalta_formula *, int>> stack{{root, 0}}; // (af, index of its next dep)
+            while (!stack.empty())
+            {
+                aalta_formula *f = stack.back().first;
+                if (done(f))
+                {
+                    stack.pop_back();
+                    continue;
+                }
+                aalta_formula *d = dep(f, stack.back().second++);
+                if (d == nullptr)
+                {
+                    stack.pop_back();
+                    step(f);
+                }
+                else if (!done(d))
+                    stack.push_back({d, 0});
+            }
+        }
+
+        // the deps of most transforms: the i-th child, i.e. the operands of an n-ary af, or left and right
+        aalta_formula *child(aalta_formula *f, int i)
+        {
+            if (f->n_ops() > 0)
+                return i < f->n_ops() ? f->operand(i) : nullptr;
+            if (f->l_af() == nullptr) // unary, only the right one
+                i++;
+            return i == 0 ? f->l_af() : (i == 1 ? f->r_af() : nullptr);
+        }
+
+        // the parser of `aalta_formula(input)`, its buffers are reused by the next input of the thread
+        af_parser &parser()
+        {
+            static thread_local af_parser res;
+            return res;
+        }
+    }
+
     aalta_formula::aalta_formula()
         : op_(e_undefined),
           left_(nullptr),
@@ -51,7 +105,14 @@ namespace aalta
          * CODE: this = new aalta_formula(getAST(input), false);
          */
         // *this = aalta_formula(getAST(input), false);
-        build(getAST(input), false); // 这样少一次 ctor 创建对象的消耗
+        // NOTE: `af_parser` instead of `getAST()`, the same trees without a malloc per node, see af_parser.h
+        build(parser().parse(input), false); // 这样少一次 ctor 创建对象的消耗
+        calc_hash();
+    }
+
+    aalta_formula::aalta_formula(const char *input, size_t len)
+    {
+        build(parser().parse(input, len), false);
         calc_hash();
     }
 
@@ -68,15 +129,34 @@ namespace aalta
      * a static method
      *  - used in unique() func
      * TODO: I think that `unique()` and `all_afs` can be extracted into a extra class
+     *
+     * NOTE: the unique af is constructed in the slot `max_id_` of `nodes_` instead of `new`,
+     *       define AF_HEAP_NODES to get back the old layout (one heap block per af), e.g. for benchmarks
+     * NOTE: it does NOT insert the af into `all_afs`, `unique()` does it under the lock of the shard.
+     *       the ids are taken atomically, so they stay unique (but not ordered) when several threads intern
      */
     aalta_formula *aalta_formula::add_into_all_afs(const aalta_formula *af)
     {
+        af_context &c = ctx();
+        const int id = c.max_id_.fetch_add(1, std::memory_order_relaxed);
+#ifdef AF_HEAP_NODES
         aalta_formula *new_unique_ptr = new aalta_formula(*af); // 对应旧的 clone 函数
-        aalta_formula::all_afs.insert(new_unique_ptr);
-        new_unique_ptr->id_ = max_id_++;
+#else
+        aalta_formula *new_unique_ptr = c.nodes_.construct(id, *af);
+#endif
+        new_unique_ptr->id_ = id;
         new_unique_ptr->unique_ = new_unique_ptr;
-        aalta_formula::id_to_af.insert({new_unique_ptr->id_, new_unique_ptr});
-        aalta_formula::id_to_afs.insert({new_unique_ptr->id_, new_unique_ptr->to_string()});
+        new_unique_ptr->attrs_ = af->calc_attrs(); // the operands of \@af are still valid here
+        if (af->n_ops_ > 0) // the operands of \@af may be in a temporary array, see `make_nary()`
+        {
+            new_unique_ptr->ops_ = c.ops_pool_.alloc(af->n_ops_);
+            std::copy(af->ops_, af->ops_ + af->n_ops_, new_unique_ptr->ops_);
+        }
+#ifdef AF_HEAP_NODES
+        c.id_to_af.slot(id)->store(new_unique_ptr, std::memory_order_release);
+#endif
+        if (new_unique_ptr->op_ == e_not)
+            c.id_to_not_af.slot(new_unique_ptr->right_->id_)->store(new_unique_ptr, std::memory_order_release);
         return new_unique_ptr;
     }
 
@@ -84,47 +164,208 @@ namespace aalta
     {
         if (unique_ != NULL)
             return unique_;
-        this->af_s_ = this->to_string();
-        afp_set::const_iterator iter = all_afs.find(this);
-        unique_ = (iter != all_afs.end())
-                      ? (*iter)
-                      : aalta_formula::add_into_all_afs(this);
-        unique_->af_s_ = unique_->to_string();
+        if (n_ops_ == 0 && is_and_or_or()) // the binary form, e.g. `aalta_formula(e_and, l, r)`
+        {
+            aalta_formula *ops[2] = {left_, right_};
+            unique_ = make_nary(op_, ops, 2);
+            return unique_;
+        }
+        // NOTE: the children are always unique, so they can be identified by their ids
+        const af_handle h = ctx().all_afs.intern(
+            table_key(), hash_,
+            [this]() -> af_handle
+            { return aalta_formula::add_into_all_afs(this)->id_; },
+            [this](af_handle h)
+            { return n_ops_ == 0 || same_ops(get_af_by_id(h)); });
+        unique_ = get_af_by_id(h);
         return unique_;
     }
 
+    /**
+     * flatten the operands of the same operator, sort them by id and remove the duplicates,
+     * so `a & (b & a)`, `(b & a) & a` and `b & a` are all the unique &(a, b)
+     * NOTE: the operands MUST be unique afs
+     */
+    aalta_formula *aalta_formula::make_nary(int op, aalta_formula *const *ops, size_t n)
+    {
+        assert(op == e_and || op == e_or);
+        static thread_local std::vector<aalta_formula *> flat;
+        flat.clear();
+        for (size_t i = 0; i < n; i++)
+        {
+            assert(ops[i]->id_ != 0);
+            if (ops[i]->op_ == op)
+                flat.insert(flat.end(), ops[i]->ops_, ops[i]->ops_ + ops[i]->n_ops_);
+            else
+                flat.push_back(ops[i]);
+        }
+        std::sort(flat.begin(), flat.end(), [](const aalta_formula *a, const aalta_formula *b)
+                  { return a->id_ < b->id_; });
+        flat.erase(std::unique(flat.begin(), flat.end()), flat.end());
+        if (flat.size() == 1)
+            return flat[0];
+        aalta_formula tmp;
+        tmp.op_ = op;
+        tmp.ops_ = flat.data();
+        tmp.n_ops_ = flat.size();
+        tmp.calc_hash();
+        return tmp.unique(); // copies the operands out of `flat`
+    }
+
+    bool aalta_formula::same_ops(const aalta_formula *af) const
+    {
+        return n_ops_ == af->n_ops_ && std::equal(ops_, ops_ + n_ops_, af->ops_);
+    }
+
+    /**
+     * Turn on/off the concurrent mode, in which `unique()`, `get_id_by_name()` and `to_string()`
+     * may be called from several threads at the same time:
+     *  - the unique table is sharded, and each shard is locked while looking up/inserting
+     *  - the names and the print cache are guarded by `names_mutex_`
+     *  - the memos (e.g. `simp_`) are atomic, so the transforms may also run in parallel
+     *
+     * NOTE: call it when no other thread is using afs.
+     *       TRUE/FALSE/TAIL/NTAIL are created lazily, so they are created here beforehand.
+     */
+    void aalta_formula::set_concurrent(bool on)
+    {
+        if (on)
+            TRUE(), FALSE(), TAIL(), NTAIL();
+        ctx().all_afs.set_concurrent(on);
+    }
+
+    /**
+     * make room for \@ n unique afs in the unique table,
+     * useful before building a large spec, to avoid rehashing again and again
+     */
+    void aalta_formula::reserve(size_t n)
+    {
+        ctx().all_afs.reserve(n);
+    }
+
+    /**
+     * rule-based simplification over the DAG, bottom-up:
+     * the children are simplified first (memoized in `simp_`), then the rules of the op are applied once,
+     * each rule returns an af which is simplified already, so the result is a fixpoint of the rules.
+     * see `simplify_nary()`, `simplify_next()`, `simplify_until()` and `simplify_release()` for the rules.
+     *
+     * NOTE: all rules hold for LTLf (finite traces), X is the strong next, e.g. X true is NOT true,
+     *       as it says that there is a next state. `simplify()` may run after `add_tail()`, see `simplify_nary()`.
+     */
     aalta_formula *aalta_formula::simplify()
     {
-        if (simp_ != NULL)
-            return simp_;
+        if (id_ == 0)
+            return unique()->simplify();
+        if (simp_ == NULL)
+            post_order(
+                this, [](aalta_formula *f)
+                { return f->simp_ != NULL; },
+                child, [](aalta_formula *f)
+                { f->simplify_node(); });
+        return simp_;
+    }
 
+    // NOTE: the children are simplified already, see `post_order()`
+    void aalta_formula::simplify_node()
+    {
+        aalta_formula *simp;
         switch (op_)
         {
-        // case e_and: // &
-        //     simp_ = aalta_formula::simplify_and(left_, right_);
-        //     break;
-        // case e_or: // |
-        //     simp_ = aalta_formula::simplify_or(left_, right_);
-        //     break;
-        // case e_next: // X
-        //     simp_ = aalta_formula::simplify_next(right_);
-        //     break;
+        case e_and: // &
+        case e_or:  // |
+        {
+            std::vector<aalta_formula *> ops(n_ops_);
+            for (int i = 0; i < n_ops_; i++)
+                ops[i] = ops_[i]->simplify();
+            simp = simplify_nary(op_, ops);
+            break;
+        }
+        case e_next: // X
+            simp = simplify_next(right_->simplify());
+            break;
         case e_until: // U
-            simp_ = simplify_until(left_, right_);
+            simp = simplify_until(left_->simplify(), right_->simplify());
             break;
         case e_release: // R
-            simp_ = simplify_release(left_, right_);
+            simp = simplify_release(left_->simplify(), right_->simplify());
             break;
         case e_not: // ! 只会出现在原子前，因此可不做处理
                     // break;
         default:    // atom
-            simp_ = unique();
+            simp = this;
             break;
         }
 
-        /* TOOD: the below line may could be optimized */
-        simp_->unique_ = simp_->simp_ = simp_;
-        return simp_;
+        // NOTE: simp is simplified, so its memo is itself, unless it has one already (which is simp then, too)
+        if (simp->simp_ == NULL)
+            simp->simp_ = simp;
+        simp_ = simp;
+    }
+
+    /**
+     * \@ops are simplified already, the rules (op is & or |, `unit` is true for & and false for |):
+     *  - a & true = a, a | false = a
+     *  - a & false = false, a | true = true
+     *  - a & !a = false, a | !a = true
+     *  - !Tail & X true = !Tail, i.e. `X true` says there is a next state, which `!Tail` says already.
+     *    it is the form `add_tail()` gives to `X true`, e.g. from N(true) or X(true)
+     * the rules are checked on the operands flattened by `make_nary()`, e.g. !Tail & (a & X true) = a & !Tail,
+     * so the result doesn't depend on how the operands were nested.
+     */
+    aalta_formula *aalta_formula::simplify_nary(int op, std::vector<aalta_formula *> &ops)
+    {
+        const int unit = op == e_and ? e_true : e_false;
+        aalta_formula *zero = op == e_and ? FALSE() : TRUE();
+        // the top-level units and zeros, so they are not interned in res
+        size_t n = 0;
+        for (aalta_formula *it : ops)
+        {
+            if (it->op_ == unit)
+                continue;
+            if (it == zero)
+                return zero;
+            ops[n++] = it;
+        }
+        if (n == 0)
+            return op == e_and ? TRUE() : FALSE();
+
+        aalta_formula *res = make_nary(op, ops.data(), n);
+        if (res->op_ != op) // a single operand, simplified already
+            return res;
+        // the operands of res are sorted by id, so !a (and !Tail) is found by a binary search for a
+        auto has = [res](const aalta_formula *af)
+        {
+            return std::binary_search(res->ops_, res->ops_ + res->n_ops_, af,
+                                      [](const aalta_formula *a, const aalta_formula *b)
+                                      { return a->id_ < b->id_; });
+        };
+        const bool has_ntail = op == e_and && has(NTAIL());
+        ops.clear();
+        for (int i = 0; i < res->n_ops_; i++)
+        {
+            aalta_formula *it = res->ops_[i];
+            if (it->op_ == unit || (has_ntail && it->op_ == e_next && it->right_->op_ == e_true))
+                continue;
+            if (it == zero || (it->op_ == e_not && has(it->right_)))
+                return zero;
+            ops.push_back(it);
+        }
+        if ((int)ops.size() == res->n_ops_)
+            return res;
+        if (ops.empty())
+            return op == e_and ? TRUE() : FALSE();
+        return make_nary(op, ops.data(), ops.size()); // flat already, so only the dropped operands are gone
+    }
+
+    /**
+     * NOTE: X false = false, as no next state satisfies false.
+     *       but X true is kept, see `simplify_nary()`.
+     */
+    aalta_formula *aalta_formula::simplify_next(aalta_formula *r)
+    {
+        if (r->op_ == e_false)
+            return r;
+        return aalta_formula(e_next, nullptr, r).unique();
     }
 
     /**
@@ -133,17 +374,18 @@ namespace aalta
      *  - G(b) is enough, so it could start with b is true, a could be false forever
      *  - F(b) must be true, i.e. b must be true at some future time point
      * NOTE: don't forget to check simp cannot be nullptr
+     * NOTE: \@l and \@r are simplified already
     */
-    aalta_formula *aalta_formula::simplify_until(aalta_formula *l, aalta_formula *r)
+    aalta_formula *aalta_formula::simplify_until(aalta_formula *l_simp, aalta_formula *r_simp)
     {
-        aalta_formula *l_simp = l->simplify();
-        aalta_formula *r_simp = r->simplify();
         aalta_formula *simp;
 
         if (false
             || l_simp->oper() == e_false // false U b = b, as b must be true at current time point, and it's enough to make `false U b` to be true
             || r_simp->oper() == e_false // a U false = false, as F(b) must be true and F(b) === F(false) === false now
             || r_simp->oper() == e_true  // a U true = true, as G(b) is enough and G(b) === G(true) === true now
+            || l_simp == r_simp          // a U a = a, the first a is enough
+            || (r_simp->oper() == e_until && r_simp->left_ == l_simp) // a U (a U b) = a U b, e.g. F F a = F a
         )
             simp = r_simp;
 
@@ -159,11 +401,10 @@ namespace aalta
      *  - b must be true at first/before released
      *  - G(b) is enough, so a can always be false, as only as b is true forever
      * NOTE: don't forget to check simp cannot be nullptr
+     * NOTE: \@l and \@r are simplified already
     */
-    aalta_formula *aalta_formula::simplify_release(aalta_formula *l, aalta_formula *r)
+    aalta_formula *aalta_formula::simplify_release(aalta_formula *l_simp, aalta_formula *r_simp)
     {
-        aalta_formula *l_simp = l->simplify();
-        aalta_formula *r_simp = r->simplify();
         aalta_formula *simp;
 
         if (false 
@@ -171,6 +412,8 @@ namespace aalta
             || l_simp->oper() == e_true  // true R b = b, as b must be true at current time point (because b must be true at first/before released), and it's enough to make `true R b` to be true 
             || r_simp->oper() == e_false // a R false = false, as false must be true at first/before release, and it's enought to judge `a R false` is false
             || r_simp->oper() == e_true  // a R true = true, as G(b) is enough, and G(b) === G(true) === true now
+            || l_simp == r_simp          // a R a = a, a is released at once
+            || (r_simp->oper() == e_release && r_simp->left_ == l_simp) // a R (a R b) = a R b, e.g. G G a = G a
         )
             simp = r_simp;
 
@@ -179,7 +422,7 @@ namespace aalta
             || (l_simp->oper() == e_not && l_simp->right_ == r_simp)    // !a R a  === G( a) === false R  a, as  a can never be released, since the released time point required `!a & a`
             || (r_simp->oper() == e_not && r_simp->right_ == l_simp)    //  a R !a === G(!a) === false R !a, as !a can never be released, since the released time point required ` a & !a`
         )
-            simp = aalta_formula(e_release, FALSE(), r_simp).simplify();
+            simp = simplify_release(FALSE(), r_simp);
         
         else
             simp = aalta_formula(e_release, l_simp, r_simp).unique();
@@ -187,216 +430,452 @@ namespace aalta
         return simp;
     }
 
-    /* I think `simplify_and()` func is meaningless, at least not so important, as SAT can handle this. */
-    // aalta_formula *aalta_formula::simplify_and(aalta_formula *l, aalta_formula *r)
-    // {
-    //     aalta_formula *l_simp = l->simplify();
-    //     aalta_formula *r_simp = r->simplify();
-
-    //     /* This case ( true & true ) is included in the below two cases */
-    //     // if(l_simp->oper() == e_true && r_simp->oper() == e_true)
-    //     //     return TRUE();
-    //     if(l_simp->oper() == e_true)
-    //         return r_simp;
-    //     if(r_simp->oper() == e_true)
-    //         return l_simp;
-    //     if(l_simp->oper() == e_false || r_simp->oper() == e_false)
-    //         return FALSE();
-    // }
-
     /**
      * 将ltl_formula转成aalta_formula结构，
      * 并处理！运算，使其只会出现在原子前
      * @param formula
      * @param is_not 标记此公式前是否有！
      *
-     * TODO:
-     *  - build 函数中, 使用 `aalta_formula().unique()` 方法会创建2~3次对象, 想办法提高效率减少对象创建次数
-     *      - 比如, 用一个函数解决此问题
+     * NOTE: no recursion, see `build_unique()`
      */
     void
     aalta_formula::build(const ltl_formula *formula, bool is_not)
     {
         if (formula == NULL)
             return;
-        switch (formula->_type)
+        *this = *build_unique(formula, is_not);
+    }
+
+    namespace
+    {
+        // one ltl_formula to build in `build_unique()`
+        struct build_frame
         {
-        case eTRUE: // True - [! True = False]
-            op_ = is_not ? e_false : e_true;
-            break;
-        case eFALSE: // False - [! False = True]
-            op_ = is_not ? e_true : e_false;
-            break;
-        case eLITERAL: // atom
-            build_atom(formula->_var, is_not);
-            break;
-        case eNOT:
-            build(formula->_right, is_not ^ 1);
-            break;
-        case eNEXT:      // Xa -- [!(Xa) = N(!a) = Tail | X(!a)]
-            if (!is_not) // Xa
+            const ltl_formula *f;
+            bool is_not;
+            bool expanded; // its operands are built (they are on the top of the value stack)
+            uintptr_t key; // key of the memo, 0 if it is not memoized
+        };
+
+        // the operands of the ltl op \@f, in the order `build_op()` takes them: (ltl_formula, is_not)
+        int build_args(const ltl_formula *f, bool is_not, const ltl_formula **args, bool *nots)
+        {
+            switch (f->_type)
             {
-                op_ = e_next;
-                right_ = aalta_formula(formula->_right, is_not).unique();
+            case eNEXT:
+            case eWNEXT:
+            case eGLOBALLY:
+            case eFUTURE:
+                args[0] = f->_right, nots[0] = is_not;
+                return 1;
+            case eUNTIL:
+            case eWUNTIL:
+            case eRELEASE:
+            case eAND:
+            case eOR:
+                args[0] = f->_left, nots[0] = is_not;
+                args[1] = f->_right, nots[1] = is_not;
+                return 2;
+            case eIMPLIES: // a->b = !a|b
+                args[0] = f->_left, nots[0] = !is_not;
+                args[1] = f->_right, nots[1] = is_not;
+                return 2;
+            case eEQUIV: // a, !a, b, !b
+                args[0] = args[1] = f->_left, nots[0] = false, nots[1] = true;
+                args[2] = args[3] = f->_right, nots[2] = false, nots[3] = true;
+                return 4;
+            default:
+                return 0;
             }
-            else // N(!a)
+        }
+    }
+
+    /**
+     * The ltl_formula is walked with an explicit stack (and the afs of the operands are kept on a value stack),
+     * so deep formulas (e.g. 10^6 nested X) don't overflow the call stack.
+     *
+     * The derived operators (W, ->, <->, N, !X) are lowered to the unique afs directly (see `build_op()`),
+     * no temporary ltl_formula is created. Both operands of <-> are needed in both polarities,
+     * and so are the <-> inside them, so they are memoized, or nested <-> would be built exponentially many times.
+     */
+    aalta_formula *aalta_formula::build_unique(const ltl_formula *formula, bool is_not)
+    {
+        // reused by the next call, e.g. every `aalta_formula(input)` of a batch
+        static thread_local std::vector<build_frame> stack;
+        static thread_local std::vector<aalta_formula *> vals;
+        stack.assign(1, {formula, is_not, false, 0});
+        vals.clear();
+        std::unordered_map<uintptr_t, aalta_formula *> memo; // (ltl_formula ptr | is_not) -> af, malloc'ed so bit 0 is free
+        const ltl_formula *args[4];
+        bool nots[4];
+        while (!stack.empty())
+        {
+            build_frame &top = stack.back();
+            const ltl_formula *f = top.f;
+            aalta_formula *res = nullptr;
+            if (top.expanded)
             {
-                ltl_formula *not_a = create_operation(eNOT, NULL, formula->_right);
-                ltl_formula *N_not_a = create_operation(eWNEXT, NULL, not_a);
-                build(N_not_a, false);
-                destroy_node(not_a);
-                destroy_node(N_not_a);
+                const int n = build_args(f, top.is_not, args, nots);
+                vals.resize(vals.size() - n);
+                res = build_op(f->_type, top.is_not, vals.data() + vals.size());
             }
-            break;
-        case eWNEXT:     // [Na = Tail | Xa ] -- [!(Na) = X(!a)]
-            if (!is_not) // Tail | Xa
+            else if (top.key != 0 && memo.count(top.key))
             {
-                ltl_formula *Xa = create_operation(eNEXT, NULL, formula->_right);
-                *this = *(aalta_formula(e_or, TAIL(), to_af(Xa)).unique());
-                destroy_node(Xa);
+                vals.push_back(memo[top.key]);
+                stack.pop_back();
+                continue;
             }
-            else // X(!a)
+            else if (f->_type == eNOT) // build the operand instead, with the key of !
             {
-                ltl_formula *not_a = create_operation(eNOT, NULL, formula->_right);
-                ltl_formula *X_not_a = create_operation(eNEXT, NULL, not_a);
-                build(X_not_a, false);
-                destroy_node(not_a);
-                destroy_node(X_not_a);
+                top.f = f->_right;
+                top.is_not = !top.is_not;
+                continue;
             }
-            break;
+            else if (f->_type == eTRUE || f->_type == eFALSE) // True - [! True = False]
+                res = (f->_type == eTRUE) != top.is_not ? TRUE() : FALSE();
+            else if (f->_type == eLITERAL)
+            {
+                aalta_formula atom;
+                atom.build_atom(f->_var, top.is_not);
+                atom.calc_hash();
+                res = atom.unique();
+            }
+            else
+            {
+                const int n = build_args(f, top.is_not, args, nots);
+                if (n == 0)
+                    // print_error("the formula cannot be recognized by aalta!");
+                    // may be:
+                    //  - type/input error syntax formula
+                    //  - need add codes for new/custom defined operator
+                    exit(1);
+                top.expanded = true;
+                const bool shared = f->_type == eEQUIV;
+                for (int i = n - 1; i >= 0; i--) // NOTE: `top` is invalid after a push
+                    stack.push_back({args[i], nots[i], false,
+                                     shared ? reinterpret_cast<uintptr_t>(args[i]) | (nots[i] ? 1 : 0) : 0});
+                continue;
+            }
+            if (stack.back().key != 0)
+                memo[stack.back().key] = res;
+            stack.pop_back();
+            vals.push_back(res);
+        }
+        return vals.back();
+    }
+
+    /**
+     * @param args the afs of the operands, see `build_args()`
+     */
+    aalta_formula *aalta_formula::build_op(int type, bool is_not, aalta_formula *const *args)
+    {
+        switch (type)
+        {
+        case eNEXT: // Xa -- [!(Xa) = N(!a) = Tail | X(!a)]
+            if (!is_not)
+                return aalta_formula(e_next, nullptr, args[0]).unique();
+            return aalta_formula(e_or, TAIL(), aalta_formula(e_next, nullptr, args[0]).unique()).unique();
+        case eWNEXT: // [Na = Tail | Xa ] -- [!(Na) = X(!a)]
+            if (!is_not)
+                return aalta_formula(e_or, TAIL(), aalta_formula(e_next, nullptr, args[0]).unique()).unique();
+            return aalta_formula(e_next, nullptr, args[0]).unique();
         case eGLOBALLY: // G a = False R a -- [!(G a) = True U !a]
             if (is_not)
-                op_ = e_until, left_ = TRUE();
-            else
-                op_ = e_release, left_ = FALSE();
-            right_ = aalta_formula(formula->_right, is_not).unique();
-            break;
+                return aalta_formula(e_until, TRUE(), args[0]).unique();
+            return aalta_formula(e_release, FALSE(), args[0]).unique();
         case eFUTURE: // F a = True U a -- [!(F a) = False R !a]
             if (is_not)
-                op_ = e_release, left_ = FALSE();
-            else
-                op_ = e_until, left_ = TRUE();
-            right_ = aalta_formula(formula->_right, is_not).unique();
-            break;
+                return aalta_formula(e_release, FALSE(), args[0]).unique();
+            return aalta_formula(e_until, TRUE(), args[0]).unique();
         case eUNTIL: // a U b -- [!(a U b) = !a R !b]
-            op_ = is_not ? e_release : e_until;
-            left_ = aalta_formula(formula->_left, is_not).unique();
-            right_ = aalta_formula(formula->_right, is_not).unique();
-            break;
-        case eWUNTIL: // a W b = (G a) | (a U b) -- [!(a W b) = F !a /\ (!a R !b)]
-        {
-            ltl_formula *Ga = create_operation(eGLOBALLY, NULL, formula->_left);
-            ltl_formula *aUb = create_operation(eUNTIL, formula->_left, formula->_right);
-            ltl_formula *now = create_operation(eOR, Ga, aUb);
-            *this = *(aalta_formula(now, is_not).unique());
-            destroy_node(Ga);
-            destroy_node(aUb);
-            break;
-        }
+            return aalta_formula(is_not ? e_release : e_until, args[0], args[1]).unique();
         case eRELEASE: // a R b -- [!(a R b) = !a U !b]
-            op_ = is_not ? e_until : e_release;
-            left_ = aalta_formula(formula->_left, is_not).unique();
-            right_ = aalta_formula(formula->_right, is_not).unique();
-            break;
+            return aalta_formula(is_not ? e_until : e_release, args[0], args[1]).unique();
+        case eWUNTIL: // a W b = (G a) | (a U b) -- [!(a W b) = F !a /\ (!a R !b)], a is shared by both sides
+        {
+            // NOTE: the sides are built one after another (not as args of one call), so the ids don't depend on the compiler
+            aalta_formula *l = is_not ? aalta_formula(e_until, TRUE(), args[0]).unique()
+                                      : aalta_formula(e_release, FALSE(), args[0]).unique();
+            aalta_formula *r = aalta_formula(is_not ? e_release : e_until, args[0], args[1]).unique();
+            return aalta_formula(is_not ? e_and : e_or, l, r).unique();
+        }
         case eAND: // a & b -- [!(a & b) = !a | !b ]
-            op_ = is_not ? e_or : e_and;
-            left_ = aalta_formula(formula->_left, is_not).unique();
-            right_ = aalta_formula(formula->_right, is_not).unique();
-            break;
+            return aalta_formula(is_not ? e_or : e_and, args[0], args[1]).unique();
         case eOR: // a | b -- [!(a | b) = !a & !b]
-            op_ = is_not ? e_and : e_or;
-            left_ = aalta_formula(formula->_left, is_not).unique();
-            right_ = aalta_formula(formula->_right, is_not).unique();
-            break;
-        case eIMPLIES: // a->b = !a|b
+        case eIMPLIES: // a->b = !a|b -- [!(a->b) = a & !b], the polarity of a is flipped in `build_args()`
+            return aalta_formula(is_not ? e_and : e_or, args[0], args[1]).unique();
+        case eEQUIV: // a<->b = (!a|b)&(!b|a) -- [!(a<->b) = (a&!b)|(b&!a)], args: a, !a, b, !b
         {
-            ltl_formula *not_a = create_operation(eNOT, NULL, formula->_left);
-            ltl_formula *now = create_operation(eOR, not_a, formula->_right);
-            *this = *(aalta_formula(now, is_not).unique());
-            destroy_node(not_a);
-            destroy_node(now);
-            break;
-        }
-        case eEQUIV: // a<->b = (a->b)&(b->a)
-        {
-            ltl_formula *imply_left = create_operation(eIMPLIES, formula->_left, formula->_right);
-            ltl_formula *imply_right = create_operation(eIMPLIES, formula->_right, formula->_left);
-            ltl_formula *now = create_operation(eAND, imply_left, imply_right);
-            *this = *(aalta_formula(now, is_not).unique());
-            destroy_node(imply_left);
-            destroy_node(imply_right);
-            destroy_node(now);
-            // 为什么 destroy 顺序是这样的? 如果顺序错了会有影响吗?
-            break;
+            aalta_formula *a = args[0], *not_a = args[1], *b = args[2], *not_b = args[3];
+            const int inner = is_not ? e_and : e_or;
+            aalta_formula *l = is_not ? aalta_formula(inner, a, not_b).unique() : aalta_formula(inner, not_a, b).unique();
+            aalta_formula *r = is_not ? aalta_formula(inner, b, not_a).unique() : aalta_formula(inner, not_b, a).unique();
+            return aalta_formula(is_not ? e_or : e_and, l, r).unique();
         }
         default:
-            // print_error("the formula cannot be recognized by aalta!");
-            // may be:
-            //  - type/input error syntax formula
-            //  - need add codes for new/custom defined operator
             exit(1);
-            break;
         }
     }
 
     /* 初始化非静态成员变量 */
     /* 初始化静态成员变量 */
-    std::vector<std::string> aalta_formula::names = {
-        "true", "false", "Literal", "!", "|", "&", "X", "N", "U", "R", "Undefined"}; // 存储操作符的名称以及原子变量的名称
-    std::unordered_map<std::string, int> aalta_formula::name_id_map;                 // 名称和对应的位置映射
-    int aalta_formula::max_id_ = 1;
-    aalta_formula::afp_set aalta_formula::all_afs;
-    std::map<int, aalta_formula *> aalta_formula::id_to_af;
-    std::map<int, std::string> aalta_formula::id_to_afs;
-    aalta_formula *aalta_formula::TRUE_ = nullptr;
-    aalta_formula *aalta_formula::FALSE_ = nullptr;
-    aalta_formula *aalta_formula::TAIL_ = nullptr;
-    aalta_formula *aalta_formula::NTAIL_ = nullptr;
+#ifdef DEBUG
+    bool aalta_formula::print_cache_on_ = true; // tracing prints the same afs again and again
+#else
+    bool aalta_formula::print_cache_on_ = false;
+#endif
+
+    af_context af_context::global_;
+    thread_local af_context *af_context::current_ = &af_context::global_;
+
+    af_context::af_context()
+        : max_id_(1), FALSE_(nullptr), TRUE_(nullptr), TAIL_(nullptr), NTAIL_(nullptr)
+    {
+        init_names();
+    }
+
+    af_context::~af_context()
+    {
+        assert(current_ != this || this == &global_); // don't drop the context in use
+        free_nodes();
+    }
+
+    void af_context::init_names()
+    {
+        names = {"true", "false", "Literal", "!", "|", "&", "X", "N", "U", "R", "Undefined"};
+        name_id_map.clear();
+    }
+
+    void af_context::free_nodes()
+    {
+#ifdef AF_HEAP_NODES
+        for (int id = 1; id < max_id_; id++)
+            delete id_to_af.find(id)->load();
+        id_to_af.release();
+#endif
+        nodes_.clear();
+    }
+
+    /**
+     * NOTE: the memory of the nodes, the table and the names is given back,
+     *       the tables shrink to their initial sizes
+     */
+    void af_context::reset()
+    {
+        free_nodes();
+        ops_pool_.release();
+        all_afs.clear();
+        id_to_not_af.release();
+        memos_.release();
+        std::vector<std::string>().swap(print_cache_);
+        std::unordered_map<std::string, int>().swap(name_id_map);
+        init_names();
+        max_id_ = 1;
+        FALSE_ = TRUE_ = TAIL_ = NTAIL_ = nullptr;
+    }
+
+    af_context *af_context::use(af_context *ctx)
+    {
+        af_context *prev = current_;
+        current_ = ctx == nullptr ? &global_ : ctx;
+        return prev;
+    }
 
     aalta_formula *aalta_formula::TRUE()
     {
-        if (TRUE_ == nullptr)
-            TRUE_ = aalta_formula(e_true).unique();
-        return TRUE_;
+        af_context &c = ctx();
+        if (c.TRUE_ == nullptr)
+            c.TRUE_ = aalta_formula(e_true).unique();
+        return c.TRUE_;
     }
     aalta_formula *aalta_formula::FALSE()
     {
-        if (FALSE_ == nullptr)
-            FALSE_ = aalta_formula(e_false).unique();
-        return FALSE_;
+        af_context &c = ctx();
+        if (c.FALSE_ == nullptr)
+            c.FALSE_ = aalta_formula(e_false).unique();
+        return c.FALSE_;
     }
     aalta_formula *aalta_formula::TAIL()
     {
-        if (TAIL_ == nullptr)
+        af_context &c = ctx();
+        if (c.TAIL_ == nullptr)
         {
             auto tail_s_arr = {"tail", "Tail", "TAIL"};
             const int tail_id = aalta_formula::get_id_by_names(tail_s_arr);
-            TAIL_ = aalta_formula(tail_id).unique();
+            c.TAIL_ = aalta_formula(tail_id).unique();
         }
-        return TAIL_;
+        return c.TAIL_;
     }
     aalta_formula *aalta_formula::NTAIL()
     {
-        if (NTAIL_ == nullptr)
-            NTAIL_ = aalta_formula(e_not, NULL, TAIL()).unique();
-        return NTAIL_;
+        af_context &c = ctx();
+        if (c.NTAIL_ == nullptr)
+            c.NTAIL_ = aalta_formula(e_not, NULL, TAIL()).unique();
+        return c.NTAIL_;
+    }
+
+    // the 64-bit finalizer of MurmurHash3, every input bit affects every output bit
+    static inline uint64_t mix64(uint64_t x)
+    {
+        x ^= x >> 33;
+        x *= 0xff51afd7ed558ccdULL;
+        x ^= x >> 33;
+        x *= 0xc4ceb9fe1a85ec53ULL;
+        x ^= x >> 33;
+        return x;
     }
 
     /**
      * 计算hash值
+     *
+     * NOTE: the old shift-xor version `(h << 5) ^ (h >> 27) ^ child` collided a lot on
+     *       regular families, e.g. `a U (a U (a U ...))` and X towers.
+     *       Now each step multiplies by an odd constant before mixing,
+     *       so the hash depends on the order of op, left and right.
      */
     inline void
     aalta_formula::calc_hash()
     {
-        hash_ = 1315423911; // HASH_INIT;
-        hash_ = (hash_ << 5) ^ (hash_ >> 27) ^ op_;
+        static const uint64_t K = 0x9e3779b97f4a7c15ULL; // 2^64 / phi
+        static const uint64_t NO_CHILD = 0x2545f4914f6cdd1dULL;
+        uint64_t h = mix64(uint64_t(op_) + K);
+        if (n_ops_ > 0)
+        {
+            for (int i = 0; i < n_ops_; i++)
+                h = mix64(h * K + ops_[i]->hash_);
+            hash_ = h;
+            return;
+        }
+        h = mix64(h * K + (left_ != NULL ? left_->hash_ : NO_CHILD));
+        h = mix64(h * K + (right_ != NULL ? right_->hash_ : NO_CHILD));
+        hash_ = h;
+    }
+
+    /**
+     * NOTE: it walks the af, so it is for statistics, not for the hot paths
+     */
+    int aalta_formula::dag_size() const
+    {
+        std::vector<char> seen(unique_size() + 1, 0);
+        std::vector<const aalta_formula *> stack{this};
+        int res = 0;
+        while (!stack.empty())
+        {
+            const aalta_formula *f = stack.back();
+            stack.pop_back();
+            if (f == nullptr || (f->id_ != 0 && seen[f->id_]))
+                continue;
+            if (f->id_ != 0)
+                seen[f->id_] = 1;
+            res++;
+            stack.push_back(f->left_);
+            stack.push_back(f->right_);
+            stack.insert(stack.end(), f->ops_, f->ops_ + f->n_ops_);
+        }
+        return res;
+    }
+
+    af_fingerprint aalta_formula::fingerprint() const
+    {
+        assert(id_ != 0);
+        static const uint64_t K = 0x9e3779b97f4a7c15ULL;
+        static const uint64_t NO_CHILD = 0x2545f4914f6cdd1dULL;
+        static const uint64_t SEED[2] = {0x243f6a8885a308d3ULL, 0x13198a2e03707344ULL}; // one per half
+        const std::vector<std::string> &names = ctx().names;
+
+        // the fingerprints of the afs reachable from this one, by id, so a lookup costs O(the DAG of this af)
+        // and not O(the context)
+        std::unordered_map<int, af_fingerprint> res;
+        std::vector<af_fingerprint> ops;
+        auto of = [&res](const aalta_formula *f)
+        { return f != nullptr ? res.at(f->id_) : af_fingerprint{NO_CHILD, NO_CHILD}; };
+        post_order(
+            const_cast<aalta_formula *>(this), [&res](aalta_formula *f)
+            { return res.count(f->id_) > 0; },
+            child, [&](aalta_formula *f)
+            {
+                ops.clear();
+                if (f->n_ops_ > 0)
+                {
+                    for (int i = 0; i < f->n_ops_; i++)
+                        ops.push_back(of(f->ops_[i]));
+                    std::sort(ops.begin(), ops.end());
+                }
+                else if (!f->is_literal()) // the name of an atom is hashed below
+                {
+                    ops.push_back(of(f->left_));
+                    ops.push_back(of(f->right_));
+                }
+                uint64_t h[2];
+                for (int k = 0; k < 2; k++)
+                {
+                    h[k] = mix64(SEED[k] + (f->is_literal() ? e_literal : f->op_));
+                    if (f->is_literal())
+                        for (const char c : names[f->op_])
+                            h[k] = mix64(h[k] * K + (unsigned char)c);
+                    else
+                        for (const af_fingerprint &op : ops)
+                            h[k] = mix64(h[k] * K + (k == 0 ? op.hi : op.lo));
+                }
+                res[f->id_] = {h[0], h[1]};
+            });
+        return res.at(id_);
+    }
+
+    /**
+     * the attributes of this af from those of its children (which are unique), see `af_attr`
+     */
+    uint32_t aalta_formula::calc_attrs() const
+    {
+        uint32_t res = 0, xdepth = 0;
+        bool all_wider_globally = true;
+        auto add = [&](const aalta_formula *c)
+        {
+            if (c == nullptr)
+                return;
+            res |= c->attrs_ & attr_temporal;
+            xdepth = std::max(xdepth, c->attrs_ >> attr_xdepth_shift);
+            all_wider_globally = all_wider_globally && (c->attrs_ & attr_wider_globally);
+        };
+        add(left_);
+        add(right_);
+        for (int i = 0; i < n_ops_; i++)
+            add(ops_[i]);
 
-        if (left_ != NULL)
-            hash_ = (hash_ << 5) ^ (hash_ >> 27) ^ left_->hash_;
-        if (right_ != NULL)
-            hash_ = (hash_ << 5) ^ (hash_ >> 27) ^ right_->hash_;
+        switch (op_)
+        {
+        case e_next:
+        case e_w_next:
+            res |= attr_temporal;
+            xdepth = std::min<uint32_t>(xdepth + 1, attr_xdepth_max);
+            break;
+        case e_until:
+            res |= attr_temporal;
+            if (left_->op_ == e_true)
+                res |= attr_future;
+            break;
+        case e_release:
+            res |= attr_temporal;
+            if (left_->op_ == e_false)
+                res |= attr_globally | attr_wider_globally;
+            break;
+        case e_and:
+        case e_or:
+            if (all_wider_globally)
+                res |= attr_wider_globally;
+            break;
+        default:
+            break;
+        }
+        return res | (xdepth << attr_xdepth_shift);
+    }
 
-        hash_ = (hash_ << 5) ^ (hash_ >> 27);
+    /**
+     * print the statistics of the unique table, see `af_table::print_stats()`
+     */
+    void aalta_formula::print_table_stats(std::ostream &os)
+    {
+        ctx().all_afs.print_stats(os);
     }
 
     /**
@@ -406,7 +885,7 @@ namespace aalta
      */
     bool aalta_formula::operator==(const aalta_formula &af) const
     {
-        return left_ == af.left_ && right_ == af.right_ && op_ == af.op_; // && tag_ == af.tag_;
+        return left_ == af.left_ && right_ == af.right_ && op_ == af.op_ && same_ops(&af); // && tag_ == af.tag_;
     }
 
     /**
@@ -424,6 +903,9 @@ namespace aalta
         {
             this->left_ = af.left_;
             this->right_ = af.right_;
+            this->ops_ = af.ops_;
+            this->n_ops_ = af.n_ops_;
+            this->attrs_ = af.attrs_;
             // this->tag_ = af.tag_;
             this->op_ = af.op_;
             this->hash_ = af.hash_;
@@ -467,7 +949,7 @@ namespace aalta
         // > I think it's impossible. Because the build_atom function doesn't use `e_literal`;
         // > It just use id instead.
         // return oper() == e_literal;
-        return left_ == nullptr && right_ == nullptr;
+        return left_ == nullptr && right_ == nullptr && n_ops_ == 0;
         /**
          * OR
          *  - `oper() > e_undefined` 但是这样判断会漏掉 true 和 false
@@ -475,23 +957,140 @@ namespace aalta
     }
     bool aalta_formula::is_unary() const
     {
-        return left_ == nullptr;
+        return left_ == nullptr && n_ops_ == 0;
     }
 
+    /**
+     * NOTE: strings are only built here, on demand, so nothing is printed unless someone asks for it
+     */
     std::string aalta_formula::to_string() const
     {
-        if (is_literal())
-            return aalta_formula::names[oper()];
+        std::string res;
+        to_string(res);
+        return res;
+    }
 
-        std::string inner_s;
-        std::string operator_s = aalta_formula::names[oper()];
+    /**
+     * The old version returned `"(" + l->to_string() + op + r->to_string() + ")"`,
+     * which copies the strings of all subformulas once per level, i.e. quadratic for deep afs.
+     * Now every char is appended only once.
+     *
+     * If the print cache is on, the string of each unique af is kept after the first print.
+     */
+    void aalta_formula::to_string(std::string &out) const
+    {
+        std::unique_lock<std::mutex> lock(ctx().names_mutex_, std::defer_lock);
+        if (concurrent())
+            lock.lock();
+        print_to(out);
+    }
 
-        if (is_unary())
-            inner_s = operator_s + " " + right_->to_string();
-        else
-            inner_s = left_->to_string() + " " + operator_s + " " + right_->to_string();
+    namespace
+    {
+        // one piece of `print_to()`
+        struct print_item
+        {
+            enum
+            {
+                af,     // print \@f
+                close,  // append \@start ')'
+                spaced, // append " \@s "
+                cache,  // the string of \@f is done, it starts at \@start in the output
+            } kind;
+            const aalta_formula *f;
+            const char *s;
+            size_t start;
+        };
+    }
+
+    /**
+     * NOTE: no recursion, the pieces are put onto an explicit stack in the reverse order,
+     *       so deep afs (e.g. 10^6 nested X) don't overflow the call stack
+     */
+    void aalta_formula::print_to(std::string &out) const
+    {
+        std::vector<std::string> &print_cache = ctx().print_cache_;
+        const std::vector<std::string> &names = ctx().names;
+        std::vector<print_item> stack{{print_item::af, this, nullptr, 0}};
+        while (!stack.empty())
+        {
+            const print_item it = stack.back();
+            stack.pop_back();
+            switch (it.kind)
+            {
+            case print_item::close:
+                out.append(it.start, ')');
+                continue;
+            case print_item::spaced:
+                out += ' ';
+                out += it.s;
+                out += ' ';
+                continue;
+            case print_item::cache:
+                if (print_cache.size() <= (size_t)it.f->id_)
+                    print_cache.resize(it.f->id_ + 1);
+                print_cache[it.f->id_] = out.substr(it.start);
+                continue;
+            case print_item::af:
+                break;
+            }
+            // print f, then go on with its first child at once (the rest of f is put onto the stack)
+            for (const aalta_formula *f = it.f; f != nullptr;)
+            {
+                const bool cached = print_cache_on_ && f->id_ != 0;
+                if (cached && (size_t)f->id_ < print_cache.size() && !print_cache[f->id_].empty())
+                {
+                    out += print_cache[f->id_];
+                    break;
+                }
+                if (f->is_literal())
+                {
+                    out += names[f->oper()];
+                    break;
+                }
+                const char *name = names[f->oper()].c_str();
+                if (cached)
+                    stack.push_back({print_item::cache, f, nullptr, out.size()});
+                if (!stack.empty() && stack.back().kind == print_item::close) // e.g. the ")))" of X X X a
+                    stack.back().start++;
+                else
+                    stack.push_back({print_item::close, nullptr, nullptr, 1});
+                out += '(';
+                if (f->n_ops_ > 0) // (a & b & c)
+                {
+                    for (int i = f->n_ops_ - 1; i > 0; i--)
+                    {
+                        stack.push_back({print_item::af, f->ops_[i], nullptr, 0});
+                        stack.push_back({print_item::spaced, nullptr, name, 0});
+                    }
+                    f = f->ops_[0];
+                }
+                else if (f->is_unary()) // (X a)
+                {
+                    out += name;
+                    out += ' ';
+                    f = f->right_;
+                }
+                else // (a U b)
+                {
+                    stack.push_back({print_item::af, f->right_, nullptr, 0});
+                    stack.push_back({print_item::spaced, nullptr, name, 0});
+                    f = f->left_;
+                }
+            }
+        }
+    }
 
-        return "(" + inner_s + ")";
+    /**
+     * Turn on/off the print cache. It is on by default only when DEBUG is defined,
+     * as in that case the same afs are printed again and again.
+     * Turning it off also frees the cached strings.
+     */
+    void aalta_formula::set_print_cache(bool on)
+    {
+        print_cache_on_ = on;
+        if (!on)
+            std::vector<std::string>().swap(ctx().print_cache_);
     }
 
     // to_s_string
@@ -508,7 +1107,7 @@ namespace aalta
         {
             if (s != "")
                 s += ", ";
-            s += label_af->to_string();
+            label_af->to_string(s);
         }
         return s;
     }
@@ -520,50 +1119,155 @@ namespace aalta
      */
     aalta_formula *aalta_formula::add_tail()
     {
-        if (this == nullptr) // I'm not sure about the correctness of this.
-            return nullptr;
-        aalta_formula *res = nullptr;
+        // NOTE: don't test `this == nullptr` (the compiler drops it, as it is UB), test the children instead
+        if (id_ == 0)
+            return unique()->add_tail();
+        aalta_formula *res = memo(memo_add_tail);
+        if (res != nullptr)
+            return res;
+        post_order(
+            this, [](aalta_formula *f)
+            { return f->memo(memo_add_tail) != nullptr; },
+            child, [](aalta_formula *f)
+            { f->set_memo(memo_add_tail, f->add_tail_node()); });
+        return memo(memo_add_tail);
+    }
+
+    // NOTE: the children are done already, see `post_order()`
+    aalta_formula *aalta_formula::add_tail_node()
+    {
         if (is_next())
         {
             aalta_formula *new_next = aalta_formula(e_next, nullptr, right_->add_tail()).unique();
-            res = aalta_formula(e_and, NTAIL(), new_next).unique();
+            return aalta_formula(e_and, NTAIL(), new_next).unique();
+        }
+        if (n_ops_ > 0)
+        {
+            std::vector<aalta_formula *> ops(n_ops_);
+            for (int i = 0; i < n_ops_; i++)
+                ops[i] = ops_[i]->add_tail();
+            return make_nary(op_, ops.data(), ops.size());
+        }
+        return aalta_formula(oper(),
+                             left_ == nullptr ? nullptr : left_->add_tail(),
+                             right_ == nullptr ? nullptr : right_->add_tail())
+            .unique();
+    }
+
+    namespace
+    {
+        // the deps of `split_next()` and `normalize()`: X(a & b) needs X a and X b, others need their children
+        aalta_formula *split_dep(aalta_formula *f, int i)
+        {
+            if (f->oper() != e_next || !f->r_af()->is_and_or_or())
+                return child(f, i);
+            return i < f->r_af()->n_ops() ? aalta_formula(e_next, NULL, f->r_af()->operand(i)).unique() : nullptr;
         }
-        else
-            res = aalta_formula(oper(), left_->add_tail(), right_->add_tail()).unique();
-        return res;
     }
 
     aalta_formula *aalta_formula::split_next()
     {
-        if (this == nullptr) // I'm not sure about the correctness of this.
-            return nullptr;
+        if (id_ == 0)
+            return unique()->split_next();
         if (is_literal())
             return this;
 
-        aalta_formula *res;
+        aalta_formula *res = memo(memo_split_next);
+        if (res != nullptr)
+            return res;
+        post_order(
+            this, [](aalta_formula *f)
+            { return f->is_literal() || f->memo(memo_split_next) != nullptr; },
+            split_dep, [](aalta_formula *f)
+            { f->set_memo(memo_split_next, f->split_next_node()); });
+        return memo(memo_split_next);
+    }
+
+    // NOTE: the deps are done already, see `split_dep()`
+    aalta_formula *aalta_formula::split_next_node()
+    {
         if (oper() == e_next)
         {
             if (right_->oper() == e_and || right_->oper() == e_or)
-            // e.g. X(a & b) = X(a) & X(b)
+            // e.g. X(a & b & c) = X(a) & X(b) & X(c)
             {
-                aalta_formula *left_next = aalta_formula(oper(), NULL, right_->left_).unique();
-                aalta_formula *right_next = aalta_formula(oper(), NULL, right_->right_).unique();
-                res = aalta_formula(right_->oper(), left_next->split_next(), right_next->split_next()).unique();
+                std::vector<aalta_formula *> nexts(right_->n_ops_);
+                for (int i = 0; i < right_->n_ops_; i++)
+                    nexts[i] = aalta_formula(oper(), NULL, right_->ops_[i]).unique()->split_next();
+                return make_nary(right_->oper(), nexts.data(), nexts.size());
             }
-            else
+            // NOTE: the old code split the result again `if (right_->oper() == e_and || right_->oper() == e_or)`,
+            //       which never holds here, so it is dropped
+            return aalta_formula(oper(), NULL, right_->split_next()).unique();
+        }
+        if (n_ops_ > 0)
+        {
+            std::vector<aalta_formula *> ops(n_ops_);
+            for (int i = 0; i < n_ops_; i++)
+                ops[i] = ops_[i]->split_next();
+            return make_nary(op_, ops.data(), ops.size());
+        }
+        return aalta_formula(oper(),
+                             left_ == nullptr ? nullptr : left_->split_next(),
+                             right_ == nullptr ? nullptr : right_->split_next())
+            .unique();
+    }
+
+    /**
+     * simplify(add_tail(split_next(f))) without building split_next(f) and add_tail(f):
+     *  - X(a & b)  -> X a' & X b', where X a' is the result of `X a`, so the split Xs get their tails at once
+     *  - X a       -> !Tail /\ X a', a is not & or |
+     *  - otherwise the same op over the results of the children
+     * where a' is the result of a, and every new af is built by the rules of `simplify()` at once.
+     */
+    aalta_formula *aalta_formula::normalize()
+    {
+        if (id_ == 0)
+            return unique()->normalize();
+        if (is_literal())
+            return this;
+        aalta_formula *res = memo(memo_normalize);
+        if (res != nullptr)
+            return res;
+        post_order(
+            this, [](aalta_formula *f)
+            { return f->is_literal() || f->memo(memo_normalize) != nullptr; },
+            split_dep, [](aalta_formula *f)
+            { f->set_memo(memo_normalize, f->normalize_node()); });
+        return memo(memo_normalize);
+    }
+
+    // NOTE: the deps are done already, see `split_dep()`
+    aalta_formula *aalta_formula::normalize_node()
+    {
+        std::vector<aalta_formula *> ops;
+        if (op_ == e_next)
+        {
+            if (right_->oper() == e_and || right_->oper() == e_or)
             {
-                res = aalta_formula(oper(), NULL, right_->split_next()).unique();
-                if (right_->oper() == e_and || right_->oper() == e_or)
-                {
-                    // TODO: I couldn't understand the following code
-                    //       give me an example!
-                    res = res->split_next();
-                }
+                ops.resize(right_->n_ops_);
+                for (int i = 0; i < right_->n_ops_; i++)
+                    ops[i] = aalta_formula(e_next, NULL, right_->ops_[i]).unique()->normalize();
+                return simplify_nary(right_->oper(), ops);
             }
+            ops = {NTAIL(), simplify_next(right_->normalize())};
+            return simplify_nary(e_and, ops);
         }
-        else
-            res = aalta_formula(oper(), left_->split_next(), right_->split_next()).unique();
-        return res;
+        if (n_ops_ > 0)
+        {
+            ops.resize(n_ops_);
+            for (int i = 0; i < n_ops_; i++)
+                ops[i] = ops_[i]->normalize();
+            return simplify_nary(op_, ops);
+        }
+        if (op_ == e_until)
+            return simplify_until(left_->normalize(), right_->normalize());
+        if (op_ == e_release)
+            return simplify_release(left_->normalize(), right_->normalize());
+        return aalta_formula(oper(),
+                             left_ == nullptr ? nullptr : left_->normalize(),
+                             right_ == nullptr ? nullptr : right_->normalize())
+            .simplify();
     }
 
     aalta_formula *to_af(const ltl_formula *formula)
@@ -572,17 +1276,14 @@ namespace aalta
     }
 
     /**
-     * TODO: merge it to the below func `to_set()`, recursion -> loop?
+     * NOTE: no recursion any more, the conjuncts are just the operands of the n-ary &
      */
     void aalta_formula::to_set(af_prt_set &result)
     {
         if (oper() != e_and)
             result.insert(this);
-        else
-        {
-            left_->to_set(result);
-            right_->to_set(result);
-        }
+        else // NOTE: the operands are flattened, none of them is an &
+            result.insert(ops_, ops_ + n_ops_);
     }
 
     aalta_formula::af_prt_set aalta_formula::to_set()
@@ -592,19 +1293,14 @@ namespace aalta
         return result;
     }
 
-    // TODO: understand it and optimize
+    // the disjuncts, i.e. the operands of the n-ary |
     aalta_formula::af_prt_set aalta_formula::to_or_set()
     {
         af_prt_set res;
         if (oper() != e_or)
             res.insert(this);
-        else
-        {
-            af_prt_set tmp = left_->to_or_set();
-            res.insert(tmp.begin(), tmp.end());
-            tmp = right_->to_or_set();
-            res.insert(tmp.begin(), tmp.end());
-        }
+        else // NOTE: the operands are flattened, none of them is an |
+            res.insert(ops_, ops_ + n_ops_);
         return res;
     }
 
@@ -616,14 +1312,6 @@ namespace aalta
     {
         if (ands.empty())
             return aalta_formula::TRUE();
-        aalta_formula *res = NULL;
-        for (std::vector<aalta_formula *>::iterator it = ands.begin(); it != ands.end(); it++)
-        {
-            if (res == NULL) // just to proceed the first item of ands
-                res = *it;
-            else
-                res = aalta_formula(e_and, res, *it).unique();
-        }
-        return res;
+        return aalta_formula::make_nary(e_and, ands.data(), ands.size());
     }
 } // namespace aalta_formula
\ No newline at end of file
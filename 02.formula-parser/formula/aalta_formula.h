@@ -14,7 +14,12 @@
 #define AALTA_FORMULA_H
 
 #include "ltlparser/ltl_formula.h"
+#include "formula/af_arena.h"
+#include "formula/af_table.h"
+#include "formula/af_context.h"
+#include <atomic>
 #include <cstdlib>
+#include <mutex>
 #include <unordered_map>
 #include <map>
 #include <unordered_set>
@@ -38,7 +43,60 @@ namespace aalta {
         e_undefined
     };
 
-    class aalta_formula; // 前置声明
+    /**
+     * a memo pointer of an af (e.g. the result of `simplify()`), written once and then only read.
+     * it is an atomic with acquire/release order, so that several threads may fill the same memo,
+     * on x86 the loads and stores are still plain moves.
+     */
+    class af_memo
+    {
+    public:
+        af_memo() : p_(nullptr) {}
+        af_memo(const af_memo &o) : p_(o.get()) {}
+        af_memo &operator=(aalta_formula *p)
+        {
+            p_.store(p, std::memory_order_release);
+            return *this;
+        }
+        af_memo &operator=(const af_memo &o) { return *this = o.get(); }
+        inline aalta_formula *get() const { return p_.load(std::memory_order_acquire); }
+        inline operator aalta_formula *() const { return get(); }
+        inline aalta_formula *operator->() const { return get(); }
+
+    private:
+        std::atomic<aalta_formula *> p_;
+    };
+
+    /**
+     * structural attributes of an af, computed once when it is interned (see `aalta_formula::attrs()`),
+     * so the `is_*()` queries don't walk the &/| tree any more
+     */
+    enum af_attr
+    {
+        attr_temporal = 1 << 0,       // contains X, U or R, i.e. it is not pure propositional
+        attr_globally = 1 << 1,       // G a, i.e. false R a
+        attr_wider_globally = 1 << 2, // G a, or &/| of such afs, see `is_wider_globally()`
+        attr_future = 1 << 3,         // F a, i.e. true U a
+        attr_xdepth_shift = 16,       // the max nesting depth of X is kept in the high 16 bits
+        attr_xdepth_max = 0xffff      // ... and saturates there
+    };
+
+    /**
+     * a 128-bit structural hash of an af, see `aalta_formula::fingerprint()`,
+     * it is the same in every context and every run, e.g. the key of the verdict cache (see af_cache.h)
+     */
+    struct af_fingerprint
+    {
+        uint64_t hi = 0, lo = 0;
+        bool operator==(const af_fingerprint &o) const { return hi == o.hi && lo == o.lo; }
+        bool operator!=(const af_fingerprint &o) const { return !(*this == o); }
+        bool operator<(const af_fingerprint &o) const { return hi != o.hi ? hi < o.hi : lo < o.lo; }
+        struct hash
+        {
+            size_t operator()(const af_fingerprint &fp) const { return fp.lo; }
+        };
+    };
+
     class aalta_formula
     {
     public:
@@ -88,19 +146,30 @@ namespace aalta {
         ////////////
         //成员变量//
         //////////////////////////////////////////////////
+        // NOTE: op_, id_, hash_ and the children are put together at the front,
+        //       so the fields read on every traversal share one cache line
         int op_; // 操作符or操作数(原子atom)
+        // added for af_prt_set TYPE identification, _id is set in unique ()
+        // it is also the handle of the node in `nodes_`, 0 means not unique yet
+        int id_ = 0;
+        size_t hash_; // hash值
         aalta_formula *left_ = nullptr; // 操作符左端公式
         aalta_formula *right_ = nullptr; // 操作符右端公式
         // int length_; //公式长度
         aalta_formula *unique_ = nullptr; // 指向唯一指针标识
-        aalta_formula *simp_ = nullptr;   // 指向简化后的公式指针
-        std::string af_s_;
-        // aalta_formula *simp_ = nullptr; // 指向化简后的公式指针
-        static std::vector<std::string> names; // 存储操作符的名称以及原子变量的名称
-        static std::unordered_map<std::string, int> name_id_map; // 名称和对应的位置映射
-        static afp_set all_afs;
-        static std::map<int, aalta_formula *> id_to_af;
-        static std::map<int, std::string> id_to_afs;
+        af_memo simp_;                    // 指向简化后的公式指针
+        /**
+         * the operands of a unique & or |, which is always n-ary (left_ and right_ are nullptr then):
+         *  - nested operands of the same operator are flattened, e.g. (a & b) & c -> &(a, b, c)
+         *  - the operands are sorted by id and deduplicated, so n_ops_ >= 2
+         * `aalta_formula(e_and, l, r)` is still allowed, `unique()` turns it into the n-ary af.
+         * the array lives in `af_context::ops_pool_`
+         */
+        aalta_formula **ops_ = nullptr;
+        int n_ops_ = 0;
+        uint32_t attrs_ = 0; // see `af_attr`, set by `add_into_all_afs()`, it fills the padding after n_ops_
+        // NOTE: the unique table, the nodes and the names are in `af_context`, see `ctx()`
+        static bool print_cache_on_;                    // see `set_print_cache()`
         //////////////////////////////////////////////////
 
     public:
@@ -109,22 +178,25 @@ namespace aalta {
         aalta_formula(int op, aalta_formula *left, aalta_formula *right);
         aalta_formula(int atom_id);
         aalta_formula(const char *input);
+        aalta_formula(const char *input, size_t len); // \@input needs no '\0', e.g. a line of a file, see af_reader.h
         aalta_formula(const ltl_formula *formula, bool is_not = false);
         ~aalta_formula();
         static aalta_formula* add_into_all_afs(const aalta_formula *formula); // used in unique() func
+        static void reserve(size_t n); // make room for \@ n unique afs
+        static void print_table_stats(std::ostream &os);
+        static void set_concurrent(bool on);
+        inline static bool concurrent() { return ctx().all_afs.concurrent(); }
         aalta_formula* unique();
+        // the unique n-ary af of \@op (e_and or e_or) over \@ops, see `ops_`, it is \@ops[0] if there is only one operand
+        static aalta_formula *make_nary(int op, aalta_formula *const *ops, size_t n);
         aalta_formula* simplify();
         void build (const ltl_formula *formula, bool is_not = false);
         void build_atom(const char *name, bool is_not = false);
         static int get_id_by_name(const char *name);
         static int get_id_by_names(const std::vector<const char *> &name_arr);
         static aalta_formula *get_af_by_SAT_id(int fid);
-
-    private:
-        static aalta_formula *FALSE_;
-        static aalta_formula *TRUE_;
-        static aalta_formula *TAIL_;
-        static aalta_formula *NTAIL_;
+        static aalta_formula *get_af_by_id(int id);
+        inline static int unique_size() { return ctx().unique_size(); } // number of unique afs
 
     public:
         static aalta_formula* TRUE();
@@ -132,17 +204,44 @@ namespace aalta {
         static aalta_formula* TAIL();
         static aalta_formula* NTAIL();
         static aalta_formula *simplify_next(aalta_formula *af);
-        static aalta_formula *simplify_and(aalta_formula *l, aalta_formula *r);
-        static aalta_formula *simplify_or(aalta_formula *l, aalta_formula *r);
+        static aalta_formula *simplify_nary(int op, std::vector<aalta_formula *> &ops);
         static aalta_formula *simplify_until(aalta_formula *l, aalta_formula *r);
         static aalta_formula *simplify_release(aalta_formula *l, aalta_formula *r);
 
     private:
-        size_t hash_; // hash值
-        // added for af_prt_set TYPE identification, _id is set in unique ()
-        int id_;
-        static int max_id_; // id count for af ptr
+        // the unique af of \@formula (negated if \@is_not), see `build()`
+        static aalta_formula *build_unique(const ltl_formula *formula, bool is_not);
+        // the unique af of the ltl op \@type from the afs of its operands, see `build_unique()`
+        static aalta_formula *build_op(int type, bool is_not, aalta_formula *const *args);
+        // the context all static functions work on
+        inline static af_context &ctx() { return af_context::current(); }
+        // the memoized result of the transform \@kind of this (unique) af, nullptr if not computed yet
+        inline aalta_formula *memo(af_memo_kind kind) const
+        {
+            const af_memos *memos = ctx().memos_.find(id_);
+            return memos == nullptr ? nullptr : memos->of[kind].load(std::memory_order_acquire);
+        }
+        inline aalta_formula *set_memo(af_memo_kind kind, aalta_formula *res) const
+        {
+            ctx().memos_.slot(id_)->of[kind].store(res, std::memory_order_release);
+            return res;
+        }
         void calc_hash();
+        // NOTE: for n-ary afs the key is (op, n, id of the first operand), `same_ops()` compares the rest
+        inline af_table::key table_key() const
+        {
+            if (n_ops_ > 0)
+                return {op_, (af_handle)n_ops_, (af_handle)ops_[0]->id_};
+            return {op_, left_ == nullptr ? 0u : (af_handle)left_->id_, right_ == nullptr ? 0u : (af_handle)right_->id_};
+        }
+        bool same_ops(const aalta_formula *af) const;
+        uint32_t calc_attrs() const;
+        void print_to (std::string &out) const;
+        // the results of one af from those of its children (or deps), see `post_order()` in aalta_formula.cpp
+        void simplify_node();
+        aalta_formula *add_tail_node();
+        aalta_formula *split_next_node();
+        aalta_formula *normalize_node();
     public:
         // added for afp_set TYPE identification
         bool operator == (const aalta_formula& af) const; 
@@ -158,7 +257,14 @@ namespace aalta {
         inline bool is_globally() const;    // used in `Solver`
         inline bool is_wider_globally() const;    // used in `Solver`
         inline bool is_future() const;    // used in `Solver`
+        // see `af_attr`, O(1) also for an af which is not unique yet (its children are)
+        inline uint32_t attrs() const { return id_ != 0 ? attrs_ : calc_attrs(); }
+        inline bool is_temporal() const { return attrs() & attr_temporal; }
+        inline bool is_propositional() const { return !is_temporal(); }
+        inline int x_depth() const { return attrs() >> attr_xdepth_shift; }
         std::string to_string () const;
+        void to_string (std::string &out) const; // append the string of this af to \@ out
+        static void set_print_cache (bool on);
         std::string to_set_string ();
         static std::string to_set_string (const af_prt_set &af_prt_set_);
         inline int id() { return id_; }
@@ -166,6 +272,16 @@ namespace aalta {
         inline aalta_formula* r_af() { return right_; }
         inline int r_id() { return right_->id_; } // used in `Solver`
         inline int l_id() { return left_->id_; } // used in `Solver`
+        int dag_size() const; // number of distinct afs in this af, i.e. the size of it as a DAG
+        /**
+         * the structural hash of this (unique) af: its ops, the names of its atoms,
+         * and the operands of &/| as a multiset (they are sorted by id, which depends on the context),
+         * so it doesn't depend on the ids, i.e. on the context or on the order in which the afs were created.
+         * NOTE: it walks the af, like `dag_size()`
+         */
+        af_fingerprint fingerprint() const;
+        inline int n_ops() const { return n_ops_; } // 0 if it is not an n-ary af
+        inline aalta_formula *operand(int i) const { return ops_[i]; }
 
         /* transfer formula to specific NF(normal form) */
     public:
@@ -179,7 +295,12 @@ namespace aalta {
          * TODO: I couldn't understand why `split_next` is necessary!
          */
         aalta_formula *split_next();
-        void to_set(af_prt_set &result);    // TODO: merge it to the below func `to_set()`, recursion -> loop?
+        /**
+         * simplify(add_tail(split_next(f))) in one pass, the input of the checkers.
+         * every distinct sub-af is visited once, as the results are memoized (see `af_context::memos_`)
+         */
+        aalta_formula *normalize();
+        void to_set(af_prt_set &result);    // the conjuncts, see `n_ops()`/`operand()` to read them without a set
         af_prt_set to_set();                // used in `Solver::block_formula()`
         af_prt_set to_or_set();                // used in `Solver::block_formula()`
     };
@@ -190,13 +311,17 @@ namespace aalta {
     inline int
     aalta_formula::get_id_by_name(const char *name)
     {
+        af_context &c = ctx();
+        std::unique_lock<std::mutex> lock(c.names_mutex_, std::defer_lock);
+        if (concurrent())
+            lock.lock();
         int id; // NOTE: this is operator id, not af id
-        const auto &it = name_id_map.find(name);
-        if (it == name_id_map.end())
+        const auto &it = c.name_id_map.find(name);
+        if (it == c.name_id_map.end())
         { // 此变量名未出现过，添加之
-            id = names.size();
-            name_id_map.insert({name, id});
-            names.push_back(name);
+            id = c.names.size();
+            c.name_id_map.insert({name, id});
+            c.names.push_back(name);
         }
         else
             id = it->second;
@@ -214,25 +339,55 @@ namespace aalta {
     aalta_formula::get_id_by_names(const std::vector<const char *> &name_arr)
     {
         // TODO: check if some names in `vector<const char*> names` already exist in `aalta_formula::names`
-        const int id = names.size();
-        names.push_back(name_arr.front());
+        af_context &c = ctx();
+        std::unique_lock<std::mutex> lock(c.names_mutex_, std::defer_lock);
+        if (concurrent())
+            lock.lock();
+        const int id = c.names.size();
+        c.names.push_back(name_arr.front());
         for (auto name : name_arr)
-            name_id_map.insert({name, id});
+            c.name_id_map.insert({name, id});
         return id;
     }
 
+    /**
+     * O(1) for both polarities
+     *  - fid > 0: the af with id fid
+     *  - fid < 0: the af of `! (af with id -fid)`, i.e. the af whose SAT id is fid
+     *             it is created (only once) if it has not been created yet
+     */
     inline aalta_formula*
     aalta_formula::get_af_by_SAT_id(int fid)
     {
-        for(auto afp:all_afs)
+        aalta_formula *af = get_af_by_id(abs(fid));
+        if (af == nullptr)
         {
-            if(afp->id() == fid)
-                return afp;
-            if(afp->id() == -fid)
-                return (new aalta_formula(e_not, nullptr, afp))->unique();
+            std::cout << "not found" << std::endl;
+            exit(0);
         }
-        std::cout << "not found" << std::endl;
-        exit(0);
+        if (fid > 0)
+            return af;
+        const std::atomic<aalta_formula *> *slot = ctx().id_to_not_af.find(-fid);
+        aalta_formula *not_af = slot == nullptr ? nullptr : slot->load(std::memory_order_acquire);
+        if (not_af == nullptr)
+            not_af = aalta_formula(e_not, nullptr, af).unique(); // will be recorded in `id_to_not_af`
+        return not_af;
+    }
+
+    /**
+     * O(1), as the id is just the handle of the unique af in `nodes_`
+     * @return the unique af with \@ id, or nullptr if there is no such af
+     */
+    inline aalta_formula *
+    aalta_formula::get_af_by_id(int id)
+    {
+#ifdef AF_HEAP_NODES
+        const std::atomic<aalta_formula *> *slot = id > 0 ? ctx().id_to_af.find(id) : nullptr;
+        return slot == nullptr ? nullptr : slot->load(std::memory_order_acquire);
+#else
+        const af_arena<aalta_formula> &nodes = ctx().nodes_;
+        return (id > 0 && nodes.contains(id)) ? nodes.at(id) : nullptr;
+#endif
     }
 
     /**
@@ -272,31 +427,21 @@ namespace aalta {
     // check whether it's a G formula
     inline bool aalta_formula::is_globally() const
     {
-        /**
-         * G(a) = false R a
-         *  - 'check `oper() = R` firstly' is very important!
-         */
-        return oper() == e_release && left_->oper() == e_false;
+        // G(a) = false R a, see `calc_attrs()`
+        return attrs() & attr_globally;
     }
 
     // include more cases than `is_globally()` func
     // e.g. G(a) & G(b), G(a) | G(b)
     inline bool aalta_formula::is_wider_globally() const
     {
-        if(is_globally())
-            return true;
-        if(is_and_or_or())
-            return left_->is_wider_globally() && right_->is_wider_globally();
-        return false;
+        return attrs() & attr_wider_globally;
     }
 
     inline bool aalta_formula::is_future() const
     {
-        /**
-         * F(a) = true U a
-         *  - 'check `oper() = U` firstly' is very important!
-         */
-        return oper() == e_until && left_->oper() == e_true;
+        // F(a) = true U a, see `calc_attrs()`
+        return attrs() & attr_future;
     }
 } // namespace aalta_formula
 
@@ -0,0 +1,224 @@
+/**
+ * Slab store for the unique (hash-consed) aalta_formula nodes.
+ *
+ * File:   af_arena.h
+ * Author: Yongkang Li
+ *
+ * Created on July 10, 2023, 14:20 PM
+ */
+
+#ifndef AF_ARENA_H
+#define AF_ARENA_H
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <vector>
+#include <sys/mman.h>
+
+namespace aalta
+{
+    /**
+     * dense 32-bit handle of a unique node, it is just the `id_` of the node
+     * NOTE: handle 0 is never used, so it can be taken as `nullptr`
+     */
+    typedef uint32_t af_handle;
+
+    /**
+     * An array indexed by af_handle, made of fixed-size chunks, so
+     *  - an element never moves once its chunk is allocated
+     *  - chunks are allocated on demand, also from several threads at the same time
+     *  - the memory of a chunk is zero-filled
+     *
+     * NOTE: the chunk directory has a fixed size (MAX_CHUNKS), so it never reallocates while being read.
+     *       it is mmap'ed, so only the pages of the directory really used take memory, and it costs the same
+     *       for every context (a calloc'ed one may come from the heap and be zero-filled as a whole)
+     */
+    template <typename T, unsigned CHUNK_BITS = 12>
+    class af_chunked
+    {
+    public:
+        static const af_handle CHUNK_SIZE = af_handle(1) << CHUNK_BITS;
+        static const af_handle CHUNK_MASK = CHUNK_SIZE - 1;
+        static const size_t MAX_CHUNKS = size_t(1) << (32 - CHUNK_BITS);
+
+        static const size_t DIR_BYTES = MAX_CHUNKS * sizeof(std::atomic<T *>);
+
+        af_chunked() : n_chunks_(0), top_(0)
+        {
+            void *dir = mmap(nullptr, DIR_BYTES, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+            if (dir == MAP_FAILED)
+                throw std::bad_alloc();
+            chunks_ = static_cast<std::atomic<T *> *>(dir);
+        }
+        ~af_chunked()
+        {
+            release();
+            munmap(chunks_, DIR_BYTES);
+        }
+        af_chunked(const af_chunked &) = delete;
+        af_chunked &operator=(const af_chunked &) = delete;
+
+        // the slot of \@h, its chunk is allocated if needed
+        T *slot(af_handle h)
+        {
+            std::atomic<T *> &chunk = chunks_[h >> CHUNK_BITS];
+            T *c = chunk.load(std::memory_order_acquire);
+            if (c == nullptr)
+            {
+                T *fresh = static_cast<T *>(calloc(CHUNK_SIZE, sizeof(T)));
+                if (fresh == nullptr)
+                    throw std::bad_alloc();
+                if (chunk.compare_exchange_strong(c, fresh, std::memory_order_acq_rel))
+                {
+                    c = fresh;
+                    n_chunks_.fetch_add(1, std::memory_order_relaxed);
+                    const size_t top = (h >> CHUNK_BITS) + 1;
+                    size_t old = top_.load(std::memory_order_relaxed);
+                    while (old < top && !top_.compare_exchange_weak(old, top, std::memory_order_relaxed))
+                        ;
+                }
+                else // another thread was faster, c is its chunk now
+                    free(fresh);
+            }
+            return c + (h & CHUNK_MASK);
+        }
+
+        // the slot of \@h, or nullptr if its chunk is not allocated
+        inline T *find(af_handle h) const
+        {
+            T *c = chunks_[h >> CHUNK_BITS].load(std::memory_order_acquire);
+            return c == nullptr ? nullptr : c + (h & CHUNK_MASK);
+        }
+
+        inline size_t bytes() const { return n_chunks_.load(std::memory_order_relaxed) * CHUNK_SIZE * sizeof(T); }
+
+        // free all chunks, the elements are NOT destroyed
+        void release()
+        {
+            const size_t top = top_.load(std::memory_order_relaxed);
+            for (size_t i = 0; i < top; i++)
+            {
+                free(chunks_[i].load(std::memory_order_relaxed));
+                chunks_[i].store(nullptr, std::memory_order_relaxed);
+            }
+            n_chunks_.store(0, std::memory_order_relaxed);
+            top_.store(0, std::memory_order_relaxed);
+        }
+
+    private:
+        std::atomic<T *> *chunks_;
+        std::atomic<size_t> n_chunks_;
+        std::atomic<size_t> top_; // one past the max index of the allocated chunks
+    };
+
+    /**
+     * Nodes are constructed in the chunks of an af_chunked, so
+     *  - the address of a node never changes (`aalta_formula *` stays valid)
+     *  - nodes created one after another (i.e. with neighbouring ids) are neighbours in memory
+     *  - handle -> node is just two array indexings, no hash lookup
+     *
+     * `construct()` may be called from several threads, as long as they use different handles.
+     */
+    template <typename T, unsigned CHUNK_BITS = 12>
+    class af_arena
+    {
+    public:
+        af_arena() : size_(1) {} // handle 0 is reserved
+        ~af_arena() { clear(); }
+
+        // copy-construct a node from \@orig at handle \@h, allocate the chunk if needed
+        T *construct(af_handle h, const T &orig)
+        {
+            assert(h != 0);
+            T *slot = chunks_.slot(h);
+            new (slot) T(orig);
+            af_handle size = size_.load(std::memory_order_relaxed);
+            while (h >= size && !size_.compare_exchange_weak(size, h + 1, std::memory_order_relaxed))
+                ;
+            return slot;
+        }
+
+        inline T *at(af_handle h) const
+        {
+            assert(contains(h));
+            return chunks_.find(h);
+        }
+
+        inline bool contains(af_handle h) const { return h != 0 && h < size(); }
+        inline af_handle size() const { return size_.load(std::memory_order_relaxed); }
+        inline size_t bytes() const { return chunks_.bytes(); }
+
+        // destroy all nodes and release all chunks, NOT thread-safe
+        void clear()
+        {
+            for (af_handle h = 1; h < size(); h++)
+                at(h)->~T();
+            chunks_.release();
+            size_.store(1, std::memory_order_relaxed);
+        }
+
+    private:
+        af_chunked<T, CHUNK_BITS> chunks_;
+        std::atomic<af_handle> size_; // one past the max constructed handle
+    };
+
+    /**
+     * Bump allocator of small arrays of trivial type (e.g. the operands of the n-ary afs),
+     * they are never freed one by one, only all together by `release()`.
+     */
+    template <typename T>
+    class af_pool
+    {
+    public:
+        static const size_t BLOCK_SIZE = 4096;
+
+        af_pool() : cur_(nullptr), left_(0), bytes_(0) {}
+        ~af_pool() { release(); }
+        af_pool(const af_pool &) = delete;
+        af_pool &operator=(const af_pool &) = delete;
+
+        // NOTE: locked, as unique afs may be created by several threads (in different shards)
+        T *alloc(size_t n)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (n > left_)
+            {
+                const size_t size = n > BLOCK_SIZE ? n : BLOCK_SIZE;
+                cur_ = static_cast<T *>(malloc(size * sizeof(T)));
+                if (cur_ == nullptr)
+                    throw std::bad_alloc();
+                blocks_.push_back(cur_);
+                left_ = size;
+                bytes_ += size * sizeof(T);
+            }
+            T *res = cur_;
+            cur_ += n, left_ -= n;
+            return res;
+        }
+
+        void release()
+        {
+            for (T *b : blocks_)
+                free(b);
+            blocks_.clear();
+            cur_ = nullptr, left_ = 0, bytes_ = 0;
+        }
+
+        inline size_t bytes() const { return bytes_; }
+
+    private:
+        std::mutex mutex_;
+        std::vector<T *> blocks_;
+        T *cur_;      // the free part of the last block
+        size_t left_; // size of the free part
+        size_t bytes_;
+    };
+}
+
+#endif
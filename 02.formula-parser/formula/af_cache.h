@@ -0,0 +1,238 @@
+/**
+ * The on-disk cache of the verdicts of (normalized) formulas, shared by the runs and the processes.
+ *
+ * File:   af_cache.h
+ * Author: Yongkang Li
+ *
+ * Created on July 23, 2023, 02:15 PM
+ */
+
+#ifndef AF_CACHE_H
+#define AF_CACHE_H
+
+#include "formula/aalta_formula.h"
+#include "formula/af_reader.h"
+#include <algorithm>
+#include <chrono>
+#include <cerrno>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+
+namespace aalta
+{
+    /**
+     * fingerprint (see `aalta_formula::fingerprint()`) of a normalized af -> its verdict, the engine and the cost.
+     *
+     * The file is text, a header line and then one line per entry:
+     *      <fingerprint, 32 hex digits> <sat|unsat> <engine> <seconds> <SAT calls> <last use, ns since the epoch>
+     *  - it is loaded once, by the constructor, `find()`/`add()` then only use the memory (they are thread-safe)
+     *  - `save()` merges the entries added or found by this process into the file as it is *now*,
+     *    drops the least recently used ones beyond the capacity, and replaces the file (temp file + rename)
+     *  - the writers are serialized by an flock on "<path>.lock", the readers take no lock,
+     *    as the file is only ever replaced by a complete one
+     * so several processes may use the same cache at the same time, on a local filesystem (flock over NFS is not reliable).
+     *
+     * NOTE: the key is the af after `normalize()` (and before `SweepSolver`), so bump VERSION if a change of the
+     *       transforms may change the verdict of a normalized af, the old files are then ignored (and replaced)
+     */
+    class af_cache
+    {
+    public:
+        struct entry
+        {
+            bool sat = false;
+            std::string engine; // e.g. "car", "blsc"
+            double sec = 0;     // to check the formula
+            long sat_calls = 0;
+            int64_t used = 0; // the last use, see `now()`
+        };
+
+        static const size_t DEFAULT_CAPACITY = 1 << 16;
+
+        // an \@path which doesn't exist yet is an empty cache, see `good()` for the errors
+        explicit af_cache(const std::string &path, size_t capacity = DEFAULT_CAPACITY)
+            : path_(path), capacity_(std::max<size_t>(capacity, 1))
+        {
+            good_ = load(entries_);
+        }
+        af_cache(const af_cache &) = delete;
+        af_cache &operator=(const af_cache &) = delete;
+
+        // false if the file exists but is not a cache, it is then never written
+        bool good() const { return good_; }
+        size_t size() const
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return entries_.size();
+        }
+
+        // the entry of \@fp, it counts as a use for the LRU order
+        bool find(const af_fingerprint &fp, entry &res)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = entries_.find(fp);
+            if (it == entries_.end())
+                return false;
+            it->second.used = now();
+            touched_[fp] = it->second;
+            res = it->second;
+            return true;
+        }
+        void add(const af_fingerprint &fp, const entry &e)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            entry &res = entries_[fp] = e;
+            res.used = now();
+            touched_[fp] = res;
+        }
+
+        // write the entries added or found since the last `save()`, false on an error (the file is unchanged then)
+        bool save()
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!good_)
+                return false;
+            if (touched_.empty())
+                return true;
+            const int lock_fd = open((path_ + ".lock").c_str(), O_RDWR | O_CREAT, 0644);
+            if (lock_fd < 0)
+                return false;
+            while (flock(lock_fd, LOCK_EX) != 0)
+                if (errno != EINTR)
+                {
+                    close(lock_fd);
+                    return false;
+                }
+
+            // merge into the current file, another process may have changed it since it was loaded
+            map disk;
+            bool res = load(disk);
+            if (res)
+            {
+                for (const auto &it : touched_)
+                {
+                    auto d = disk.find(it.first);
+                    if (d == disk.end())
+                        disk.insert(it);
+                    else
+                        d->second.used = std::max(d->second.used, it.second.used);
+                }
+                evict(disk);
+                res = write(disk);
+            }
+            flock(lock_fd, LOCK_UN);
+            close(lock_fd);
+            if (res)
+                touched_.clear();
+            return res;
+        }
+
+    private:
+        typedef std::unordered_map<af_fingerprint, entry, af_fingerprint::hash> map;
+        static constexpr const char *HEADER = "# aaltaf verdict cache";
+        static const int VERSION = 1;
+
+        const std::string path_;
+        const size_t capacity_;
+        bool good_;
+        mutable std::mutex mutex_; // guards the members below
+        map entries_;
+        map touched_; // added or found since the last `save()`
+
+        static int64_t now()
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::system_clock::now().time_since_epoch())
+                .count();
+        }
+
+        // the entries of the file into \@res, a missing file is empty, false if the file is not a cache
+        bool load(map &res) const
+        {
+            af_reader reader(path_.c_str());
+            if (!reader.good())
+                return true;
+            const char *in;
+            size_t len;
+            std::string line;
+            if (!reader.next(in, len))
+                return true;
+            const std::string first(in, len);
+            if (first != header()) // an old VERSION is empty (and replaced by the next `save()`)
+                return first.compare(0, strlen(HEADER), HEADER) == 0;
+            while (reader.next(in, len))
+            {
+                line.assign(in, len);
+                af_fingerprint fp;
+                entry e;
+                char verdict[8], engine[32];
+                if (sscanf(line.c_str(), "%16" SCNx64 "%16" SCNx64 " %7s %31s %lf %ld %" SCNd64,
+                           &fp.hi, &fp.lo, verdict, engine, &e.sec, &e.sat_calls, &e.used) != 7)
+                    continue; // e.g. edited by hand, the other lines are still good
+                e.sat = strcmp(verdict, "sat") == 0;
+                e.engine = engine;
+                res[fp] = e;
+            }
+            return true;
+        }
+
+        // drop the least recently used entries of \@m beyond the capacity
+        void evict(map &m) const
+        {
+            if (m.size() <= capacity_)
+                return;
+            std::vector<int64_t> used;
+            used.reserve(m.size());
+            for (const auto &it : m)
+                used.push_back(it.second.used);
+            std::nth_element(used.begin(), used.begin() + (m.size() - capacity_), used.end());
+            const int64_t oldest_kept = used[m.size() - capacity_];
+            size_t n_older = 0; // the ones used at `oldest_kept` exactly are dropped too if there is no room
+            for (const int64_t u : used)
+                n_older += u < oldest_kept;
+            size_t drop_at_kept = m.size() - capacity_ - n_older;
+            for (auto it = m.begin(); it != m.end();)
+            {
+                if (it->second.used < oldest_kept || (it->second.used == oldest_kept && drop_at_kept > 0))
+                {
+                    drop_at_kept -= it->second.used == oldest_kept;
+                    it = m.erase(it);
+                }
+                else
+                    ++it;
+            }
+        }
+
+        // replace the file by \@m
+        bool write(const map &m) const
+        {
+            const std::string tmp = path_ + ".tmp." + std::to_string(getpid());
+            FILE *out = fopen(tmp.c_str(), "w");
+            if (out == nullptr)
+                return false;
+            fprintf(out, "%s\n", header().c_str());
+            for (const auto &it : m)
+                fprintf(out, "%016" PRIx64 "%016" PRIx64 " %s %s %.6f %ld %" PRId64 "\n", it.first.hi, it.first.lo,
+                        it.second.sat ? "sat" : "unsat", it.second.engine.c_str(), it.second.sec,
+                        it.second.sat_calls, it.second.used);
+            bool res = fflush(out) == 0 && fsync(fileno(out)) == 0;
+            res = fclose(out) == 0 && res;
+            res = res && rename(tmp.c_str(), path_.c_str()) == 0;
+            if (!res)
+                unlink(tmp.c_str());
+            return res;
+        }
+
+        static std::string header() { return std::string(HEADER) + " v" + std::to_string(VERSION); }
+    };
+}
+
+#endif
@@ -0,0 +1,127 @@
+/**
+ * The universe of aalta_formula: unique table, node storage and symbol table.
+ *
+ * File:   af_context.h
+ * Author: Yongkang Li
+ *
+ * Created on July 13, 2023, 09:40 AM
+ */
+
+#ifndef AF_CONTEXT_H
+#define AF_CONTEXT_H
+
+#include "formula/af_arena.h"
+#include "formula/af_table.h"
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace aalta
+{
+    class aalta_formula; // 前置声明
+
+    // the memoized transforms of the unique afs, see `af_context::memos_`
+    enum af_memo_kind
+    {
+        memo_split_next,
+        memo_add_tail,
+        memo_normalize,
+        memo_kinds
+    };
+
+    // the memos of one af, zero-filled (i.e. all nullptr) in a fresh chunk of `af_chunked`
+    struct af_memos
+    {
+        std::atomic<aalta_formula *> of[memo_kinds];
+    };
+
+    /**
+     * Everything `aalta_formula` used to keep in static members, so that it can be dropped or reset.
+     *
+     * The static API of `aalta_formula` works on the current context (`af_context::current()`),
+     * which is the global context unless another one is put in use, e.g. for one query:
+     *
+     *      af_context ctx;
+     *      {
+     *          af_context::scope use(ctx);
+     *          ... aalta_formula("a U b").unique() ...
+     *      } // back to the previous context
+     *      // ctx (and all its afs) is freed when it goes out of scope, or call `ctx.reset()` to reuse it
+     *
+     * NOTE: afs belong to the context they are created in,
+     *       all of them (and the ptrs to them) are invalid after the context is reset or destroyed,
+     *       so drop the Solvers/Checkers built on them first.
+     * NOTE: the current context is per thread (the global one in a new thread), so every worker thread can have
+     *       its own context and use it without any lock (see `BatchChecker`).
+     *       All threads can still share the global context, if it is in the concurrent mode (see `set_concurrent()`).
+     */
+    class af_context
+    {
+    public:
+        af_context();
+        ~af_context();
+        af_context(const af_context &) = delete;
+        af_context &operator=(const af_context &) = delete;
+
+        // drop all afs and atom names, the context is like a new one afterwards
+        void reset();
+
+        inline static af_context &current() { return *current_; }
+        inline static af_context &global() { return global_; }
+        // put \@ctx in use (the global context if it is nullptr), return the previous one
+        static af_context *use(af_context *ctx);
+
+        // RAII helper of `use()`
+        class scope
+        {
+        public:
+            explicit scope(af_context &ctx) : prev_(use(&ctx)) {}
+            ~scope() { use(prev_); }
+            scope(const scope &) = delete;
+            scope &operator=(const scope &) = delete;
+
+        private:
+            af_context *prev_;
+        };
+
+        inline int unique_size() const { return max_id_.load(std::memory_order_relaxed) - 1; }
+        // memory held by the nodes (and their memos)
+        inline size_t bytes() const
+        {
+            return nodes_.bytes() + ops_pool_.bytes() + memos_.bytes();
+        }
+
+    private:
+        friend class aalta_formula;
+
+        std::vector<std::string> names;                  // 存储操作符的名称以及原子变量的名称
+        std::unordered_map<std::string, int> name_id_map; // 名称和对应的位置映射
+        std::mutex names_mutex_;                         // guards names, name_id_map and print_cache_ in the concurrent mode
+        af_shards all_afs;                               // (op, left id, right id) -> id of the unique af
+        af_arena<aalta_formula> nodes_;                  // storage of all unique afs, indexed by id
+        af_pool<aalta_formula *> ops_pool_;              // operand arrays of the n-ary afs
+#ifdef AF_HEAP_NODES
+        af_chunked<std::atomic<aalta_formula *>> id_to_af;
+#endif
+        af_chunked<std::atomic<aalta_formula *>> id_to_not_af; // if id_to_not_af[id] == f, then f is the unique af of `! (af of id)`
+        // memos_[id].of[kind] is the result of the transform `kind` of the af of id, nullptr if not computed yet.
+        // NOTE: kept beside the nodes, so that the node still fits in one cache line (unlike `simp_`)
+        af_chunked<af_memos> memos_;
+        std::vector<std::string> print_cache_;                // strings of unique afs that have been printed, indexed by id
+        std::atomic<int> max_id_;                             // id count for af ptr
+        aalta_formula *FALSE_;
+        aalta_formula *TRUE_;
+        aalta_formula *TAIL_;
+        aalta_formula *NTAIL_;
+
+        static af_context global_;
+        static thread_local af_context *current_;
+
+        void init_names();
+        void free_nodes();
+    };
+}
+
+#endif
@@ -0,0 +1,295 @@
+/**
+ * Hand-written parser of the input syntax, in place of the flex/bison `getAST()` (see ltlparser/grammar).
+ *
+ * File:   af_parser.h
+ * Author: Yongkang Li
+ *
+ * Created on July 20, 2023, 10:15 AM
+ */
+
+#ifndef AF_PARSER_H
+#define AF_PARSER_H
+
+#include "ltlparser/ltl_formula.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace aalta
+{
+    /**
+     * Accepts the same language as ltlparser.y + ltllexer.l, and gives the same ltl_formula tree as `getAST()`:
+     *  - binary ops, all left-associative, from the loosest: <->, ->, | (||), & (&&), R (V), U, W
+     *  - prefix ops, tighter than every binary op: F (<>), G ([]), X, N, ! (~)
+     *  - true: 1 true True TRUE, false: 0 false False FALSE, atoms: [a-zA-Z_][a-zA-Z0-9_]*
+     *  - a one-letter keyword is only a keyword on its own, e.g. `Xa` is an atom (the longest match of the lexer)
+     * the errors are reported as by the bison parser, and exit(1).
+     *
+     * The operator-precedence parse runs on two explicit stacks, so there is no limit on the nesting
+     * (bison stops at YYMAXDEPTH = 10000).
+     * The nodes and the names of the atoms are put into flat buffers owned by the parser (no malloc/strdup per node),
+     * and the buffers are reused by the next `parse()`, i.e. nothing is allocated once they are large enough.
+     *
+     * NOTE: the result is only valid until the next `parse()`, and it must NOT be passed to `destroy_formula()`
+     */
+    class af_parser
+    {
+    public:
+        const ltl_formula *parse(const char *input)
+        {
+            return parse(input, strlen(input));
+        }
+
+        // \@input is not '\0'-terminated, e.g. a line of a mmap'ed file (see af_reader.h), it is not copied
+        const ltl_formula *parse(const char *input, size_t len)
+        {
+            // a token makes one node at most, and the names (each with its '\0') are not longer than the input,
+            // so the buffers never reallocate during the parse, i.e. the pointers into them stay valid
+            nodes_.clear();
+            nodes_.reserve(len);
+            names_.clear();
+            names_.reserve(len + 1);
+            vals_.clear();
+            ops_.clear();
+            cur_ = input;
+            end_ = input + len;
+
+            bool operand = true; // an operand is expected next, otherwise a binary op, ) or the end
+            for (;;)
+            {
+                const int tok = next();
+                if (operand)
+                {
+                    if (tok == eLITERAL || tok == eTRUE || tok == eFALSE)
+                    {
+                        vals_.push_back(make(tok, nullptr, nullptr));
+                        operand_done();
+                        operand = false;
+                    }
+                    else if (tok == t_lparen || is_prefix(tok))
+                        ops_.push_back(tok);
+                    else
+                        syntax_error();
+                }
+                else if (is_binary(tok))
+                {
+                    // left-associative: the ops on the stack as tight as \@tok are done first
+                    while (!ops_.empty() && ops_.back() != t_lparen && prec(ops_.back()) >= prec(tok))
+                        reduce();
+                    ops_.push_back(tok);
+                    operand = true;
+                }
+                else if (tok == t_rparen)
+                {
+                    while (!ops_.empty() && ops_.back() != t_lparen)
+                        reduce();
+                    if (ops_.empty())
+                        syntax_error();
+                    ops_.pop_back();
+                    operand_done();
+                }
+                else if (tok == t_end)
+                {
+                    while (!ops_.empty() && ops_.back() != t_lparen)
+                        reduce();
+                    if (!ops_.empty())
+                        syntax_error();
+                    return vals_.back();
+                }
+                else
+                    syntax_error();
+            }
+        }
+
+    private:
+        // the tokens which are not ops, the others are the EOperationType of the op/leaf (an atom is eLITERAL)
+        enum
+        {
+            t_end = -1,
+            t_lparen = -2,
+            t_rparen = -3
+        };
+
+        const char *cur_, *end_;
+        const char *name_;               // the name of the last eLITERAL token, see `name_len_`
+        size_t name_len_;
+        std::vector<ltl_formula> nodes_; // the nodes of the result
+        std::vector<char> names_;        // the names of the atoms, '\0'-terminated
+        std::vector<ltl_formula *> vals_; // the operands parsed
+        std::vector<int> ops_;           // the ops (and the `(`) waiting for their operands
+
+        static bool is_prefix(int tok)
+        {
+            return tok == eNOT || tok == eNEXT || tok == eWNEXT || tok == eGLOBALLY || tok == eFUTURE;
+        }
+        static bool is_binary(int tok)
+        {
+            return tok >= eUNTIL && tok <= eEQUIV;
+        }
+        // the `%left` lines of ltlparser.y, from the loosest
+        static int prec(int op)
+        {
+            switch (op)
+            {
+            case eEQUIV:
+                return 1;
+            case eIMPLIES:
+                return 2;
+            case eOR:
+                return 3;
+            case eAND:
+                return 4;
+            case eRELEASE:
+                return 5;
+            case eUNTIL:
+                return 6;
+            case eWUNTIL:
+                return 7;
+            default: // prefix ops, never on the stack when a binary op comes (see `operand_done()`)
+                return 8;
+            }
+        }
+
+        ltl_formula *make(int type, ltl_formula *left, ltl_formula *right)
+        {
+            nodes_.push_back({static_cast<EOperationType>(type), left, right, nullptr});
+            ltl_formula *res = &nodes_.back();
+            if (type == eLITERAL)
+            {
+                res->_var = names_.data() + names_.size();
+                names_.insert(names_.end(), name_, name_ + name_len_);
+                names_.push_back('\0');
+            }
+            return res;
+        }
+
+        void reduce()
+        {
+            const int op = ops_.back();
+            ops_.pop_back();
+            ltl_formula *r = vals_.back();
+            vals_.pop_back();
+            ltl_formula *l = nullptr;
+            if (!is_prefix(op))
+            {
+                l = vals_.back();
+                vals_.pop_back();
+            }
+            vals_.push_back(make(op, l, r));
+        }
+
+        // the prefix ops bind tighter than every binary op, so they are done as soon as their operand is
+        void operand_done()
+        {
+            while (!ops_.empty() && is_prefix(ops_.back()))
+                reduce();
+        }
+
+        // the lexer, see ltllexer.l
+        int next()
+        {
+            while (cur_ != end_ && (*cur_ == ' ' || *cur_ == '\r' || *cur_ == '\n' || *cur_ == '\t'))
+                cur_++;
+            if (cur_ == end_)
+                return t_end;
+            const char c = *cur_;
+            if (is_alpha(c))
+            {
+                const char *begin = cur_++;
+                while (cur_ != end_ && (is_alpha(*cur_) || (*cur_ >= '0' && *cur_ <= '9')))
+                    cur_++;
+                return word(begin, cur_ - begin);
+            }
+            cur_++;
+            switch (c)
+            {
+            case '(':
+                return t_lparen;
+            case ')':
+                return t_rparen;
+            case '|':
+                cur_ += ahead(0, '|');
+                return eOR;
+            case '&':
+                cur_ += ahead(0, '&');
+                return eAND;
+            case '!':
+            case '~':
+                return eNOT;
+            case '1':
+                return eTRUE;
+            case '0':
+                return eFALSE;
+            case '-':
+                if (ahead(0, '>'))
+                    return cur_++, eIMPLIES;
+                break;
+            case '<':
+                if (ahead(0, '-') && ahead(1, '>'))
+                    return cur_ += 2, eEQUIV;
+                if (ahead(0, '>'))
+                    return cur_++, eFUTURE;
+                break;
+            case '[':
+                if (ahead(0, ']'))
+                    return cur_++, eGLOBALLY;
+                break;
+            }
+            fprintf(stderr, "\033[31mERROR\033[0m: Unrecognized symbol: \033[34m%c\033[0m\n", c);
+            exit(1);
+        }
+
+        // whether the \@k-th char after the current one is \@c
+        bool ahead(size_t k, char c) const
+        {
+            return size_t(end_ - cur_) > k && cur_[k] == c;
+        }
+
+        static bool is_alpha(char c)
+        {
+            return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+        }
+
+        // an identifier: a keyword or an atom
+        int word(const char *s, size_t n)
+        {
+            if (n == 1)
+            {
+                switch (*s)
+                {
+                case 'R':
+                case 'V':
+                    return eRELEASE;
+                case 'U':
+                    return eUNTIL;
+                case 'W':
+                    return eWUNTIL;
+                case 'F':
+                    return eFUTURE;
+                case 'G':
+                    return eGLOBALLY;
+                case 'X':
+                    return eNEXT;
+                case 'N':
+                    return eWNEXT;
+                }
+            }
+            else if (n == 4 && (!strncmp(s, "true", 4) || !strncmp(s, "True", 4) || !strncmp(s, "TRUE", 4)))
+                return eTRUE;
+            else if (n == 5 && (!strncmp(s, "false", 5) || !strncmp(s, "False", 5) || !strncmp(s, "FALSE", 5)))
+                return eFALSE;
+            name_ = s;
+            name_len_ = n;
+            return eLITERAL;
+        }
+
+        [[noreturn]] static void syntax_error()
+        {
+            fprintf(stderr, "\033[31mERROR\033[0m: syntax error\n");
+            exit(1);
+        }
+    };
+}
+
+#endif
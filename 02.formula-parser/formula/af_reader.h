@@ -0,0 +1,181 @@
+/**
+ * The formulas of an input file (or stdin), one per line, with no limit on their size.
+ *
+ * File:   af_reader.h
+ * Author: Yongkang Li
+ *
+ * Created on July 21, 2023, 09:40 AM
+ */
+
+#ifndef AF_READER_H
+#define AF_READER_H
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace aalta
+{
+    /**
+     * Splits the input into formulas, one per line ('\n'), the blank lines are skipped.
+     *  - a regular file is mmap'ed, and a formula is just the span of its line in the map (nothing is copied)
+     *  - otherwise (stdin, a pipe) it is read in chunks, a formula is the span of its line in a buffer,
+     *    which grows as long as the line does
+     * The spans are not '\0'-terminated, see `aalta_formula(input, len)`, and a span is only valid until the next `next()`.
+     *
+     * NOTE: a formula can't span several lines, as a newline is a blank inside a formula (see ltllexer.l)
+     */
+    class af_reader
+    {
+    public:
+        // \@path "-" is stdin, see `good()` for the errors
+        explicit af_reader(const char *path)
+            : fd_(strcmp(path, "-") == 0 ? STDIN_FILENO : open(path, O_RDONLY)), own_fd_(fd_ != STDIN_FILENO)
+        {
+            init();
+        }
+        // \@fd is not closed by the reader
+        explicit af_reader(int fd) : fd_(fd), own_fd_(false)
+        {
+            init();
+        }
+        ~af_reader()
+        {
+            if (map_ != nullptr)
+                munmap(map_, map_size_);
+            if (own_fd_ && fd_ >= 0)
+                close(fd_);
+        }
+        af_reader(const af_reader &) = delete;
+        af_reader &operator=(const af_reader &) = delete;
+
+        // whether the input could be opened
+        bool good() const { return fd_ >= 0; }
+        // whether the input is mmap'ed, i.e. a regular (and not empty) file
+        bool mapped() const { return map_ != nullptr; }
+        // the line number (from 1, the blank lines counted) of the last formula of `next()`
+        long line_no() const { return line_no_; }
+
+        // the next formula, false at the end of the input
+        bool next(const char *&begin, size_t &len)
+        {
+            for (;;)
+            {
+                const char *line;
+                size_t n;
+                if (!next_line(line, n))
+                    return false;
+                if (!blank(line, n))
+                {
+                    begin = line, len = n;
+                    return true;
+                }
+            }
+        }
+
+    private:
+        static const size_t CHUNK = 1 << 16;
+
+        int fd_;
+        bool own_fd_;
+        // mmap'ed input
+        char *map_ = nullptr;
+        size_t map_size_ = 0;
+        // read input: the unread chars are buf_[pos_, end_)
+        std::vector<char> buf_;
+        size_t pos_ = 0, end_ = 0;
+        bool eof_ = false;
+        long line_no_ = 0;
+
+        void init()
+        {
+            struct stat st;
+            if (fd_ < 0 || fstat(fd_, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0)
+                return;
+            void *map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd_, 0);
+            if (map == MAP_FAILED) // e.g. /proc files, read them instead
+                return;
+            madvise(map, st.st_size, MADV_SEQUENTIAL);
+            map_ = static_cast<char *>(map);
+            map_size_ = st.st_size;
+            end_ = map_size_;
+        }
+
+        const char *data() const { return map_ != nullptr ? map_ : buf_.data(); }
+
+        // the next line (without its '\n'), the last one may have no '\n'
+        bool next_line(const char *&line, size_t &n)
+        {
+            line_no_++;
+            size_t scanned = 0; // no '\n' in the first `scanned` unread chars
+            for (;;)
+            {
+                const size_t left = end_ - pos_ - scanned;
+                const char *nl = left == 0 ? nullptr
+                                           : static_cast<const char *>(memchr(data() + pos_ + scanned, '\n', left));
+                if (nl != nullptr)
+                {
+                    line = data() + pos_;
+                    n = nl - line;
+                    pos_ += n + 1;
+                    return true;
+                }
+                scanned = end_ - pos_;
+                if (map_ != nullptr || !fill())
+                {
+                    if (pos_ == end_)
+                        return false;
+                    line = data() + pos_;
+                    n = end_ - pos_;
+                    pos_ = end_;
+                    return true;
+                }
+            }
+        }
+
+        // read more chars after the unread ones (which are moved to the front), false if there are no more
+        bool fill()
+        {
+            if (eof_ || fd_ < 0)
+                return false;
+            if (pos_ > 0)
+            {
+                memmove(buf_.data(), buf_.data() + pos_, end_ - pos_);
+                end_ -= pos_;
+                pos_ = 0;
+            }
+            if (buf_.size() - end_ < CHUNK)
+                buf_.resize(std::max(buf_.size() * 2, end_ + CHUNK));
+            for (;;)
+            {
+                const ssize_t got = read(fd_, buf_.data() + end_, buf_.size() - end_);
+                if (got > 0)
+                {
+                    end_ += got;
+                    return true;
+                }
+                if (got == 0 || errno != EINTR)
+                {
+                    eof_ = true;
+                    return false;
+                }
+            }
+        }
+
+        static bool blank(const char *s, size_t n)
+        {
+            for (size_t i = 0; i < n; i++)
+                if (s[i] != ' ' && s[i] != '\r' && s[i] != '\t')
+                    return false;
+            return true;
+        }
+    };
+}
+
+#endif
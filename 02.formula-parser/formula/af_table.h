@@ -0,0 +1,344 @@
+/**
+ * Interning table of the unique aalta_formula nodes.
+ *
+ * File:   af_table.h
+ * Author: Yongkang Li
+ *
+ * Created on July 11, 2023, 10:05 AM
+ */
+
+#ifndef AF_TABLE_H
+#define AF_TABLE_H
+
+#include "formula/af_arena.h"
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+namespace aalta
+{
+    /**
+     * Open addressing (linear probing) hash table: (op, left id, right id) -> id of the unique af.
+     *
+     * Every slot keeps the whole key and a 32-bit fingerprint of the hash inline,
+     * so a probe never touches the afs themselves, and a mismatch is nearly always
+     * decided by the fingerprint alone.
+     *
+     * NOTE: the bucket of a key is computed from its fingerprint, so rehashing needs no hash function.
+     * NOTE: if (op, l, r) is not the whole key (e.g. n-ary afs), pass a predicate to `find()` to compare the rest.
+     *
+     * Define AF_TABLE_STATS to also count the probes of every `find()`, see `stats()`.
+     */
+    class af_table
+    {
+    public:
+        struct key
+        {
+            int op;
+            af_handle l; // 0 if there is no left af
+            af_handle r; // 0 if there is no right af
+        };
+
+        struct statistics
+        {
+            // shape of the table, always available
+            size_t entries;
+            size_t buckets;
+            size_t max_cluster;      // length of the longest run of occupied buckets
+            double avg_displacement; // average distance from the home bucket to the bucket of an entry
+            size_t max_displacement;
+            size_t home_collisions;  // entries whose home bucket is also the home bucket of another entry
+            size_t fp_collisions;    // entries whose fingerprint is shared with another entry
+            // counted by `find()`, only when AF_TABLE_STATS is defined
+            size_t finds;
+            size_t probes;           // buckets visited by all finds
+            size_t max_probe;
+            size_t fp_false_hits;    // fingerprint matched but the key did not
+
+            // add up the statistics of another table, e.g. of another shard
+            statistics &operator+=(const statistics &o)
+            {
+                avg_displacement = (entries + o.entries) == 0 ? 0
+                                   : (avg_displacement * entries + o.avg_displacement * o.entries) / (entries + o.entries);
+                entries += o.entries, buckets += o.buckets;
+                max_cluster = std::max(max_cluster, o.max_cluster);
+                max_displacement = std::max(max_displacement, o.max_displacement);
+                home_collisions += o.home_collisions, fp_collisions += o.fp_collisions;
+                finds += o.finds, probes += o.probes, fp_false_hits += o.fp_false_hits;
+                max_probe = std::max(max_probe, o.max_probe);
+                return *this;
+            }
+        };
+
+        explicit af_table(size_t buckets = 1024, float max_load = 0.5f)
+            : size_(0), max_load_(max_load)
+        {
+            rehash(buckets);
+        }
+
+        // return the handle of \@k, or 0 if it is not in the table
+        af_handle find(const key &k, size_t hash) const
+        {
+            return find(k, hash, [](af_handle) { return true; });
+        }
+
+        // the same, but an entry matching (op, l, r) is only taken if \@same (its handle) is also true
+        template <typename Same>
+        af_handle find(const key &k, size_t hash, Same same) const
+        {
+            const uint32_t fp = fingerprint(hash);
+#ifdef AF_TABLE_STATS
+            size_t probe = 0;
+            finds_++;
+#endif
+            for (size_t i = bucket_of(fp);; i = (i + 1) & mask_)
+            {
+                const slot &s = slots_[i];
+#ifdef AF_TABLE_STATS
+                probes_++;
+                if (++probe > max_probe_)
+                    max_probe_ = probe;
+                if (s.h != 0 && s.fp == fp && !(s.op == k.op && s.l == k.l && s.r == k.r))
+                    fp_false_hits_++;
+#endif
+                if (s.h == 0)
+                    return 0;
+                if (s.fp == fp && s.op == k.op && s.l == k.l && s.r == k.r && same(s.h))
+                    return s.h;
+            }
+        }
+
+        // insert \@k -> \@h, \@k MUST not be in the table
+        void insert(const key &k, size_t hash, af_handle h)
+        {
+            assert(h != 0);
+            if (size_ + 1 > max_load_ * slots_.size())
+                rehash(slots_.size() * 2);
+            const uint32_t fp = fingerprint(hash);
+            place(slot{fp, h, k.op, k.l, k.r});
+            size_++;
+        }
+
+        // make room for \@n entries, so that no rehash happens before there are \@n entries
+        void reserve(size_t n)
+        {
+            size_t buckets = slots_.size();
+            while (n > max_load_ * buckets)
+                buckets *= 2;
+            if (buckets != slots_.size())
+                rehash(buckets);
+        }
+
+        // rebuild the table with at least \@buckets buckets (rounded up to a power of 2)
+        void rehash(size_t buckets)
+        {
+            size_t n = 16;
+            while (n < buckets || size_ > max_load_ * n)
+                n *= 2;
+            std::vector<slot> old(n, slot{0, 0, 0, 0, 0});
+            old.swap(slots_);
+            mask_ = n - 1;
+            bits_ = 0;
+            while ((size_t(1) << bits_) < n)
+                bits_++;
+            for (size_t i = 0; i < old.size(); i++)
+                if (old[i].h != 0)
+                    place(old[i]);
+        }
+
+        void set_max_load(float max_load)
+        {
+            assert(max_load > 0 && max_load < 1);
+            max_load_ = max_load;
+            reserve(size_);
+        }
+
+        void clear()
+        {
+            std::vector<slot>(16, slot{0, 0, 0, 0, 0}).swap(slots_);
+            size_ = 0, mask_ = 15, bits_ = 4;
+        }
+
+        statistics stats() const
+        {
+            statistics st = {size_, slots_.size(), 0, 0, 0, 0, 0, finds_, probes_, max_probe_, fp_false_hits_};
+            std::vector<size_t> home_count(slots_.size(), 0);
+            std::vector<uint32_t> fps;
+            size_t run = 0, total_displacement = 0;
+            for (size_t i = 0; i < slots_.size(); i++)
+            {
+                if (slots_[i].h == 0)
+                {
+                    run = 0;
+                    continue;
+                }
+                st.max_cluster = std::max(st.max_cluster, ++run);
+                const size_t home = bucket_of(slots_[i].fp);
+                const size_t d = (i - home) & mask_;
+                total_displacement += d;
+                st.max_displacement = std::max(st.max_displacement, d);
+                home_count[home]++;
+                fps.push_back(slots_[i].fp);
+            }
+            for (size_t i = 0; i < home_count.size(); i++)
+                if (home_count[i] > 1)
+                    st.home_collisions += home_count[i];
+            st.avg_displacement = size_ == 0 ? 0 : double(total_displacement) / size_;
+            std::sort(fps.begin(), fps.end());
+            for (size_t i = 0; i < fps.size(); i++)
+                if ((i > 0 && fps[i] == fps[i - 1]) || (i + 1 < fps.size() && fps[i] == fps[i + 1]))
+                    st.fp_collisions++;
+            return st;
+        }
+
+        void print_stats(std::ostream &os) const { print_stats(stats(), os); }
+
+        static void print_stats(const statistics &st, std::ostream &os)
+        {
+            os << "entries: " << st.entries << ", buckets: " << st.buckets
+               << ", load: " << (st.buckets == 0 ? 0 : double(st.entries) / st.buckets) << "\n"
+               << "home bucket collisions: " << st.home_collisions
+               << ", fingerprint collisions: " << st.fp_collisions << "\n"
+               << "displacement: avg " << st.avg_displacement << ", max " << st.max_displacement
+               << ", longest cluster: " << st.max_cluster << "\n";
+#ifdef AF_TABLE_STATS
+            os << "finds: " << st.finds << ", probes/find: " << (st.finds == 0 ? 0 : double(st.probes) / st.finds)
+               << ", max probe: " << st.max_probe << ", fingerprint false hits: " << st.fp_false_hits << "\n";
+#endif
+        }
+
+        inline size_t size() const { return size_; }
+        inline size_t bucket_count() const { return slots_.size(); }
+        inline float load_factor() const { return float(size_) / slots_.size(); }
+
+    private:
+        struct slot
+        {
+            uint32_t fp; // fingerprint of the hash
+            af_handle h; // 0 means empty
+            int op;
+            af_handle l;
+            af_handle r;
+        };
+        std::vector<slot> slots_;
+        size_t size_;
+        size_t mask_;
+        unsigned bits_;
+        float max_load_;
+#ifdef AF_TABLE_STATS
+        mutable size_t finds_ = 0, probes_ = 0, max_probe_ = 0, fp_false_hits_ = 0;
+#else
+        static const size_t finds_ = 0, probes_ = 0, max_probe_ = 0, fp_false_hits_ = 0;
+#endif
+
+        static inline uint32_t fingerprint(size_t hash)
+        {
+            return uint32_t(hash) ^ uint32_t(uint64_t(hash) >> 32);
+        }
+        // Fibonacci hashing, take the high bits of fp * 2^32/phi
+        inline size_t bucket_of(uint32_t fp) const
+        {
+            return size_t(uint32_t(fp * 2654435769u) >> (32 - bits_)) & mask_;
+        }
+        void place(const slot &s)
+        {
+            size_t i = bucket_of(s.fp);
+            while (slots_[i].h != 0)
+                i = (i + 1) & mask_;
+            slots_[i] = s;
+        }
+    };
+
+    /**
+     * The unique table split into SHARDS af_tables by the high bits of the hash,
+     * each shard with its own lock, so threads interning different afs rarely wait for each other.
+     *
+     * The locks are only taken in the concurrent mode (see `set_concurrent()`),
+     * the single-threaded path pays nothing but a branch.
+     */
+    class af_shards
+    {
+    public:
+        static const unsigned SHARD_BITS = 6;
+        static const size_t SHARDS = size_t(1) << SHARD_BITS;
+
+        af_shards() : concurrent_(false)
+        {
+            for (size_t i = 0; i < SHARDS; i++)
+                shards_[i].rehash(64);
+        }
+
+        /**
+         * return the handle of \@k, if \@k is not in the table yet,
+         * call \@make to create the af (it returns the new handle) and insert it.
+         * the lookup and the insertion are atomic w.r.t. other threads interning the same key
+         * \@same: see `af_table::find()`
+         */
+        template <typename Make, typename Same>
+        af_handle intern(const af_table::key &k, size_t hash, Make make, Same same)
+        {
+            const size_t s = shard_of(hash);
+            std::unique_lock<std::mutex> lock(locks_[s], std::defer_lock);
+            if (concurrent_)
+                lock.lock();
+            af_handle h = shards_[s].find(k, hash, same);
+            if (h == 0)
+            {
+                h = make();
+                shards_[s].insert(k, hash, h);
+            }
+            return h;
+        }
+
+        // NOTE: not thread-safe, call it before going concurrent
+        void reserve(size_t n)
+        {
+            for (size_t i = 0; i < SHARDS; i++)
+                shards_[i].reserve(n / SHARDS + 1);
+        }
+
+        // NOTE: not thread-safe
+        void clear()
+        {
+            for (size_t i = 0; i < SHARDS; i++)
+            {
+                shards_[i].clear();
+                shards_[i].rehash(64);
+            }
+        }
+
+        inline void set_concurrent(bool on) { concurrent_ = on; }
+        inline bool concurrent() const { return concurrent_; }
+
+        af_table::statistics stats() const
+        {
+            af_table::statistics st = shards_[0].stats();
+            for (size_t i = 1; i < SHARDS; i++)
+                st += shards_[i].stats();
+            return st;
+        }
+        void print_stats(std::ostream &os) const { af_table::print_stats(stats(), os); }
+
+        size_t size() const
+        {
+            size_t n = 0;
+            for (size_t i = 0; i < SHARDS; i++)
+                n += shards_[i].size();
+            return n;
+        }
+
+    private:
+        af_table shards_[SHARDS];
+        std::mutex locks_[SHARDS];
+        bool concurrent_;
+
+        // NOTE: the low bits decide the bucket inside a shard (via the fingerprint), so take the high bits here
+        static inline size_t shard_of(size_t hash) { return size_t(uint64_t(hash) >> (64 - SHARD_BITS)); }
+    };
+}
+
+#endif
@@ -11,13 +11,10 @@
 namespace aalta
 {
     // change last level element in `assumption_` from negative to positive, or vice verisa
-    //                                            from `l` to `l^1`, represent `x` to `-x`
+    //                                            from `x` to `-x`
     void InvSolver::disable_frame_and()
     {
-        Minisat::Lit l = assumption_.last();
-        // TODO: replace with equivalent exp: `l = ~l` or `l ^= 1`, because the return value of `last()` func is a reference!
-        assumption_.pop();
-        assumption_.push(~l);
+        assumption_.back() = -assumption_.back();
     }
 
     /**
@@ -68,6 +65,6 @@ namespace aalta
          * NOTE: this is for assumption_, which is different to add_clause! but the final effect may be the same, so 
          * ATTENTION: it is bound with `disable_frame_and()` func! They should be modified simultaneously/synchronously.
         */
-        assumption_.push(id_to_lit(frame_flag));
+        assumption_.push_back(frame_flag);
     }
 }
\ No newline at end of file
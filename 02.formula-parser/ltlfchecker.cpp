@@ -22,6 +22,7 @@ namespace aalta
 	 */
 	bool LTLfChecker::dfs_check(aalta_formula *f)
 	{
+		n_states_++;
 		if (detect_unsat())
 			return false;
 		if (sat_once(f))
@@ -61,11 +62,10 @@ namespace aalta
 			Transition *t = get_one_transition_from(f);
 			if (t != NULL) // Tail /\ xnf(\phi) is SAT
 			{
-				if (dfs_check(t->next()))
-				{
-					delete t;
+				const bool found = dfs_check(t->next());
+				delete t;
+				if (found)
 					return true;
-				}
 			}
 			else // UNSAT, cannot get new states, that means f is not used anymore
 			{
@@ -77,6 +77,17 @@ namespace aalta
 		return false;
 	}
 
+	void LTLfChecker::print_stats(std::ostream &os) const
+	{
+		os << "unique afs:  " << aalta_formula::unique_size() << std::endl
+		   << "SAT vars:    " << solver_->nVars() << std::endl
+		   << "XNF clauses: " << solver_->xnf_clauses() << std::endl
+		   << "SAT calls:   " << sat_calls() << std::endl
+		   << "dfs states:  " << n_states_ << std::endl;
+		if (Solver::preprocessing())
+			os << "eliminated:  " << solver_->nEliminated() << std::endl; // vars, see `Solver::set_preprocessing()`
+	}
+
 	Transition *LTLfChecker::get_one_transition_from(aalta_formula *f)
 	{
 		if (solver_->solve_by_assumption(f))
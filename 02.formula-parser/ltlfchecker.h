@@ -10,14 +10,15 @@
 
 #include "formula/aalta_formula.h"
 #include "solver.h"
+#include <ostream>
 
 namespace aalta
 {
 	class LTLfChecker
 	{
 	public:
-		LTLfChecker(){};
-		LTLfChecker(aalta_formula *f, bool verbose = false) : to_check_(f), verbose_(verbose)
+		LTLfChecker() : solver_(NULL), n_states_(0){};
+		LTLfChecker(aalta_formula *f, bool verbose = false) : to_check_(f), verbose_(verbose), n_states_(0)
 		{
 			solver_ = new Solver(f, verbose);
 		}
@@ -28,12 +29,17 @@ namespace aalta
 				delete solver_;
 		}
 		bool check();
+		// print the size of the search, i.e. unique afs, SAT vars and visited states, see `-stats`
+		void print_stats(std::ostream &os) const;
+		// SAT calls of `check()` so far
+		inline long sat_calls() const { return solver_->solves; }
 
 	protected:
 		// flags
 		bool verbose_;		// default is false
 		Solver *solver_; // SAT solver for computing next states
 		aalta_formula *to_check_; // used in ctor
+		long n_states_;			  // number of the states visited by `dfs_check()`
 
 		//////////functions
 		bool sat_once(aalta_formula *f); // check whether the formula can be satisfied in one step (the terminating condition of checking)
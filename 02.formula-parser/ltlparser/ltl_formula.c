@@ -155,17 +155,29 @@ print_formula (ltl_formula *root)
 
 /**
  * 销毁以root为根的表达式树
+ * 不用递归 (deep formulas, e.g. 10^6 nested X, would overflow the stack):
+ * rotate the left child up until there is none, then the root can be freed
  * @param root
  */
 void
 destroy_formula (ltl_formula *root)
 {
-  if (root == NULL) return;
-
-  destroy_formula (root->_left);
-  destroy_formula (root->_right);
-
-  destroy_node (root);
+  while (root != NULL)
+    {
+      if (root->_left != NULL)
+        {
+          ltl_formula *left = root->_left;
+          root->_left = left->_right;
+          left->_right = root;
+          root = left;
+        }
+      else
+        {
+          ltl_formula *right = root->_right;
+          destroy_node (root);
+          root = right;
+        }
+    }
 }
 
 /**
@@ -1,67 +1,197 @@
 #include "formula/aalta_formula.h"
 #include "ltlfchecker.h"
 #include "carchecker.h"
+#include "sweepsolver.h"
+#include "batchchecker.h"
+#include "formula/af_reader.h"
+#include "formula/af_cache.h"
+#include <chrono>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <iostream>
-
-#define MAXN 100000
-char in[MAXN];
+#include <memory>
+#include <thread>
 
 using namespace aalta;
 
-int main(int argc, char** argv)
-{
-    bool BLSC = false;
-
-    for (int i = argc; i > 1; i --)
-	{
-		if (strcmp (argv[i-1], "-blsc") == 0)
-			BLSC = true;
-    }
-
-    aalta_formula::TAIL(); // set tail id to be 1
-    aalta_formula(e_not, nullptr, aalta_formula::TAIL()).unique(); // set tail id to be 1
-    aalta_formula::FALSE(); // set FALSE id to be 2
-    aalta_formula::TRUE(); // set TRUE id to be 3
-    aalta_formula("a").unique();
-    aalta_formula(e_not, nullptr, aalta_formula("a").unique()).unique(); // set tail id to be 1
-    aalta_formula(e_next, nullptr, aalta_formula("a").unique()).unique(); // set tail id to be 1
-    aalta_formula("b").unique();
-    aalta_formula(e_not, nullptr, aalta_formula("b").unique()).unique(); // set tail id to be 1
-    aalta_formula(e_next, nullptr, aalta_formula("b").unique()).unique(); // set tail id to be 1
+static bool BLSC = false;
+static bool STATS = false; // print the size of the search before the result
+static bool SWEEP = false; // merge the equivalent sub-afs before building the checker, see `SweepSolver`
+static bool BATCH = false; // only one result line per formula, see `BatchChecker`
+static int THREADS = 1;    // workers of the batch, see `-j`
+static const char *CACHE = nullptr; // the file of the verdict cache, see `af_cache`
+static size_t CACHE_SIZE = af_cache::DEFAULT_CAPACITY;
+static af_cache *cache = nullptr;
 
-    puts("please input the formula:");
-    if (fgets(in, MAXN, stdin) == NULL)
-    {
-        printf("Error: read input!\n");
-        exit(0);
-    }
-    aalta_formula *af = aalta_formula(in).unique();
+// check one formula, \@in is not '\0'-terminated (see `af_reader`), see `BatchChecker::check()` for `-batch`
+static bool check(const char *in, size_t len)
+{
+    aalta_formula *af = aalta_formula(in, len).unique();
     std::cout << af->to_string() << std::endl;
 
     // af = af->nnf();              // has been done in `build()` func
     // af = af->remove_wnext();     // has been done in `build()` func
-    af = af->split_next();
-    af = af->add_tail();
-    af = af->simplify();         // just skip this now
+    // split_next() + add_tail() + simplify() in one pass
+    af = af->normalize();
+    af_fingerprint fp;
+    af_cache::entry cached;
+    if (cache != nullptr)
+    {
+        fp = af->fingerprint();
+        if (cache->find(fp, cached))
+        {
+            std::cout << "=== cached: " << cached.engine << ", " << cached.sec << " s, "
+                      << cached.sat_calls << " SAT calls" << std::endl;
+            return cached.sat;
+        }
+    }
+    const auto start = std::chrono::steady_clock::now();
+    long sat_calls = 0;
+    if (SWEEP)
+    {
+        SweepSolver sweeper(af);
+        af = sweeper.sweep();
+        sat_calls += sweeper.sat_calls();
+        if (STATS)
+            sweeper.print_stats(std::cout);
+    }
 
     std::cout << "=== after all transfer" << std::endl;
     std::cout << af->to_string() << std::endl;
+    if (STATS)
+    {
+        // the size without the rules of `simplify()`, built in a scratch context so that the ids here don't change
+        int unsimplified;
+        {
+            af_context scratch;
+            af_context::scope use(scratch);
+            unsimplified = aalta_formula(in, len).unique()->split_next()->add_tail()->dag_size();
+        }
+        std::cout << "af size:     " << unsimplified << " -> " << af->dag_size() << " (simplified)" << std::endl;
+    }
 
     bool res;
     if (BLSC)
     {
         LTLfChecker checker(af);
         res = checker.check();
+        sat_calls += checker.sat_calls();
+        if (STATS)
+            checker.print_stats(std::cout);
     }
     else
     {
         CARChecker checker(af);
         res = checker.check();
+        sat_calls += checker.sat_calls();
+        if (STATS)
+            checker.print_stats(std::cout);
+    }
+    if (cache != nullptr)
+    {
+        cached.sat = res, cached.engine = engine_name(BLSC, SWEEP);
+        cached.sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        cached.sat_calls = sat_calls;
+        cache->add(fp, cached);
+    }
+    return res;
+}
+
+/**
+ * Usage: aaltaf [-blsc] [-stats] [-sweep] [-polarity] [-preprocess] [-sat=<minisat|simp>] [-batch [-j<N>]] [-cache=<file> [-cache-size=<N>]] [input]
+ *  - no input: the formula is read from stdin (the first line)
+ *  - input: every line of the file (or of stdin if it is "-") is a formula, all checked in this process,
+ *           i.e. they share the unique afs (and what is memoized on them)
+ *  - -batch: the formulas of input (stdin if none) are checked one after another,
+ *            and only a result line is printed (and flushed) for each, as soon as it is checked:
+ *                <line no.> <sat|unsat> <wall time in seconds> <SAT calls>
+ *            where the line no. counts the blank lines too. `-stats` is ignored.
+ *            -j<N> checks N formulas at the same time (-j alone: one per core), the lines are still in the input order
+ *  - -polarity: the polarity-aware XNF encoding, see `Solver::set_polarity_encoding()`
+ *  - -preprocess: the XNF clauses are simplified once (by minisat/simp) before the search, see `Solver::set_preprocessing()`
+ *  - -sat=<backend>: the SAT solver of all checkers (default minisat), see `SatSolver`
+ *  - -cache=<file>: the verdicts are looked up in (and added to) the cache in <file> (see `af_cache`),
+ *                   by the structure of the formula after `normalize()`, so no solver is built for a known one.
+ *                   it keeps the <N> (default 65536) most recently used verdicts, and may be shared by several runs
+ */
+int main(int argc, char** argv)
+{
+    const char *input = nullptr;
+
+    for (int i = argc; i > 1; i --)
+	{
+		if (strcmp (argv[i-1], "-blsc") == 0)
+			BLSC = true;
+		else if (strcmp (argv[i-1], "-stats") == 0)
+			STATS = true;
+		else if (strcmp (argv[i-1], "-sweep") == 0)
+			SWEEP = true;
+		else if (strcmp (argv[i-1], "-polarity") == 0)
+			Solver::set_polarity_encoding(true);
+		else if (strcmp (argv[i-1], "-preprocess") == 0)
+			Solver::set_preprocessing(true);
+		else if (strncmp (argv[i-1], "-sat=", 5) == 0)
+		{
+			SatSolver::backend backend;
+			if (!SatSolver::parse (argv[i-1] + 5, backend))
+			{
+				printf("Error: unknown SAT solver %s!\n", argv[i-1] + 5);
+				exit(0);
+			}
+			SatSolver::set_default(backend);
+		}
+		else if (strcmp (argv[i-1], "-batch") == 0)
+			BATCH = true;
+		else if (strncmp (argv[i-1], "-cache=", 7) == 0)
+			CACHE = argv[i-1] + 7;
+		else if (strncmp (argv[i-1], "-cache-size=", 12) == 0)
+			CACHE_SIZE = atol (argv[i-1] + 12);
+		else if (strncmp (argv[i-1], "-j", 2) == 0)
+			THREADS = argv[i-1][2] == '\0' ? std::thread::hardware_concurrency() : atoi (argv[i-1] + 2);
+		else if (argv[i-1][0] != '-' || argv[i-1][1] == '\0')
+			input = argv[i-1];
+    }
+
+    prime_ids(); // set tail id to be 1, FALSE 2, TRUE 3, ...
+
+    if (BATCH)
+    {
+        STATS = false;
+        if (input == nullptr)
+            input = "-";
+    }
+    if (input == nullptr)
+        puts("please input the formula:");
+    af_reader reader(input == nullptr ? "-" : input);
+    const char *in;
+    size_t len;
+    if (!reader.good() || (!BATCH && !reader.next(in, len)))
+    {
+        printf("Error: read input!\n");
+        exit(0);
+    }
+    std::unique_ptr<af_cache> verdicts;
+    if (CACHE != nullptr)
+    {
+        verdicts.reset(new af_cache(CACHE, CACHE_SIZE));
+        if (!verdicts->good())
+        {
+            printf("Error: %s is not a verdict cache!\n", CACHE);
+            exit(0);
+        }
+        cache = verdicts.get();
+    }
+    if (BATCH)
+        BatchChecker(THREADS, BLSC, SWEEP, stdout, cache).run(reader);
+    else
+    {
+        do
+            printf("%s\n", check(in, len) ? "sat" : "unsat");
+        while (input != nullptr && reader.next(in, len)); // only one formula from the prompt
     }
-    printf("%s\n", res ? "sat" : "unsat");
+    if (cache != nullptr && !cache->save())
+        fprintf(stderr, "Warning: the verdicts couldn't be saved into %s\n", CACHE);
 
     return 0;
-}
\ No newline at end of file
+}
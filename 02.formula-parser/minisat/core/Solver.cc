@@ -42,6 +42,7 @@ static BoolOption    opt_luby_restart      (_cat, "luby",        "Use the Luby r
 static IntOption     opt_restart_first     (_cat, "rfirst",      "The base restart interval", 100, IntRange(1, INT32_MAX));
 static DoubleOption  opt_restart_inc       (_cat, "rinc",        "Restart interval increase factor", 2, DoubleRange(1, false, HUGE_VAL, false));
 static DoubleOption  opt_garbage_frac      (_cat, "gc-frac",     "The fraction of wasted memory allowed before a garbage collection is triggered",  0.20, DoubleRange(0, false, HUGE_VAL, false));
+static BoolOption    opt_reuse_trail       (_cat, "reuse-trail", "Reuse the decision levels of the assumptions shared with the previous call", true);
 
 
 //=================================================================================================
@@ -63,6 +64,7 @@ Solver::Solver() :
   , rnd_pol          (false)
   , rnd_init_act     (opt_rnd_init_act)
   , garbage_frac     (opt_garbage_frac)
+  , reuse_trail      (opt_reuse_trail)
   , restart_first    (opt_restart_first)
   , restart_inc      (opt_restart_inc)
 
@@ -79,6 +81,7 @@ Solver::Solver() :
     //
   , solves(0), starts(0), decisions(0), rnd_decisions(0), propagations(0), conflicts(0)
   , dec_vars(0), clauses_literals(0), learnts_literals(0), max_literals(0), tot_literals(0)
+  , reused_levels(0)
 
   , ok                 (true)
   , cla_inc            (1)
@@ -131,19 +134,28 @@ Var Solver::newVar(bool sign, bool dvar)
 
 bool Solver::addClause_(vec<Lit>& ps)
 {
-    assert(decisionLevel() == 0);
     if (!ok) return false;
 
-    // Check if clause is satisfied and remove false/duplicate literals:
+    // Check if clause is satisfied and remove false/duplicate literals (by the top-level assignments only, the
+    // levels above are the ones of the assumptions kept by the last call, see 'reuse_trail'):
     sort(ps);
     Lit p; int i, j;
     for (i = j = 0, p = lit_Undef; i < ps.size(); i++)
-        if (value(ps[i]) == l_True || ps[i] == ~p)
+        if (topValue(ps[i]) == l_True || ps[i] == ~p)
             return true;
-        else if (value(ps[i]) != l_False && ps[i] != p)
+        else if (topValue(ps[i]) != l_False && ps[i] != p)
             ps[j++] = p = ps[i];
     ps.shrink(i - j);
 
+    // The kept levels stay if two literals which are not false can be watched, otherwise the clause is unit or
+    // conflicting under them, and it is added on the top level as usual:
+    if (decisionLevel() > 0){
+        for (i = j = 0; i < ps.size() && j < 2; i++)
+            if (value(ps[i]) != l_False){
+                Lit q = ps[i]; ps[i] = ps[j]; ps[j++] = q; }
+        if (j < 2) cancelUntil(0);
+    }
+
     if (ps.size() == 0)
         return ok = false;
     else if (ps.size() == 1){
@@ -756,6 +768,15 @@ lbool Solver::solve_()
 
     solves++;
 
+    // Keep the decision levels of the longest prefix of the assumptions which is the same as in the last call.
+    // They are still propagated: no clause was added since (see 'addClause_()'), and learnt clauses are implied.
+    int reuse = 0;
+    if (reuse_trail)
+        while (reuse < decisionLevel() && reuse < assumptions.size() && assumptions[reuse] == trail_assumps[reuse])
+            reuse++;
+    cancelUntil(reuse);
+    reused_levels += reuse;
+
     max_learnts               = nClauses() * learntsize_factor;
     learntsize_adjust_confl   = learntsize_adjust_start_confl;
     learntsize_adjust_cnt     = (int)learntsize_adjust_confl;
@@ -788,7 +809,14 @@ lbool Solver::solve_()
     }else if (status == l_False && conflict.size() == 0)
         ok = false;
 
-    cancelUntil(0);
+    // The levels up to 'assumptions.size()' are those of the assumptions (see 'search()'), keep them for the next call:
+    if (reuse_trail && ok && status != l_Undef){
+        int keep = decisionLevel() < assumptions.size() ? decisionLevel() : assumptions.size();
+        cancelUntil(keep);
+        trail_assumps.clear();
+        for (int i = 0; i < keep; i++) trail_assumps.push(assumptions[i]);
+    }else
+        cancelUntil(0);
     return status;
 }
 
@@ -830,6 +858,8 @@ void Solver::toDimacs(const char *file, const vec<Lit>& assumps)
 
 void Solver::toDimacs(FILE* f, const vec<Lit>& assumps)
 {
+    cancelUntil(0); // Only the top-level assignments simplify the clauses (see 'reuse_trail').
+
     // Handle case when solver is in contradictory state:
     if (!ok){
         fprintf(f, "p cnf 1 2\n1 0\n-1 0\n");
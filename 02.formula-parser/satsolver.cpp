@@ -0,0 +1,163 @@
+/**
+ * File:   satsolver.cpp
+ * Author: Yongkang Li
+ *
+ * Created on July 26, 2023, 10:05 AM
+ */
+
+#include "satsolver.h"
+#include "minisat/core/Solver.h"
+#include "minisat/simp/SimpSolver.h"
+#include <cassert>
+#include <cstdlib>
+
+namespace aalta
+{
+    using Minisat::lbool; // of l_True, l_False, l_Undef
+
+    SatSolver::backend SatSolver::default_ = SatSolver::MINISAT;
+    SatSolver::wrapper SatSolver::wrapper_ = nullptr;
+
+    // minisat/simp: the first `solve()` simplifies the clauses so far, then it is minisat/core (see `eliminate()`)
+    static Minisat::lbool solve_limited(Minisat::SimpSolver &s, const Minisat::vec<Minisat::Lit> &assumps)
+    {
+        return s.solveLimited(assumps, true, true);
+    }
+    static Minisat::lbool solve_limited(Minisat::Solver &s, const Minisat::vec<Minisat::Lit> &assumps)
+    {
+        return s.solveLimited(assumps);
+    }
+    // a var may be used by any later clause or assumption, so none is eliminated unless by `preprocess()`
+    static void set_up(Minisat::SimpSolver &s) { s.use_elim = false; }
+    static void set_up(Minisat::Solver &) {}
+    // minisat/simp: eliminate the vars which are not frozen, and turn the simplification off (see `SatSolver::preprocess()`)
+    static bool preprocess(Minisat::SimpSolver &s)
+    {
+        s.use_elim = true;
+        const bool ok = s.eliminate(true);
+        s.use_elim = false;
+        return ok;
+    }
+    static bool preprocess(Minisat::Solver &) { return true; }
+    static void freeze(Minisat::SimpSolver &s, Minisat::Var v) { s.setFrozen(v, true); }
+    static void freeze(Minisat::Solver &, Minisat::Var) {}
+    static int eliminated(const Minisat::SimpSolver &s) { return s.eliminated_vars; }
+    static int eliminated(const Minisat::Solver &) { return 0; }
+
+    /**
+     * a minisat solver \@S (Minisat::Solver or a subclass of it) as a SatSolver,
+     * the var of the id i is i-1 (the var 0 is the id 1).
+     */
+    template <class S>
+    class MinisatSolver : public SatSolver, protected S
+    {
+    public:
+        explicit MinisatSolver(const char *name) : name_(name) { set_up(*this); }
+
+        const char *name() const override { return name_; }
+
+        // NOTE: `addClause_()` sorts and shrinks `lits_` in place, `addClause()` would copy it first
+        void add(const int *lits, int n) override
+        {
+            lits_.clear();
+            for (int i = 0; i < n; i++)
+                lits_.push(lit(lits[i]));
+            S::addClause_(lits_);
+        }
+        void assume(int l) override { assumps_.push(lit(l)); }
+        result solve() override
+        {
+            Minisat::lbool ret = solve_limited(*this, assumps_);
+            assumps_.clear();
+            S::clearInterrupt();
+            if (ret == l_True)
+                return SAT;
+            return ret == l_False ? UNSAT : UNKNOWN;
+        }
+        int val(int l) const override
+        {
+            const int v = abs(l) - 1;
+            if (v >= S::model.size() || S::model[v] == l_Undef)
+                return 0;
+            return (S::model[v] == l_True) == (l > 0) ? l : -l;
+        }
+        // `conflict` holds the negations of the failed assumptions
+        void failed(std::vector<int> &res) const override
+        {
+            res.clear();
+            for (int k = 0; k < S::conflict.size(); k++)
+                res.push_back(-id_of(S::conflict[k]));
+        }
+        void interrupt() override { S::interrupt(); }
+
+        int vars() const override { return S::nVars(); }
+        int clauses() const override { return S::nClauses(); }
+        // instead of growing every per-var array of minisat var by var in `newVar()`
+        void reserve(int n) override
+        {
+            S::assigns.capacity(n);
+            S::vardata.capacity(n);
+            S::activity.capacity(n);
+            S::seen.capacity(n);
+            S::polarity.capacity(n);
+            S::decision.capacity(n);
+            S::trail.capacity(n);
+        }
+
+        void freeze(int l) override { aalta::freeze(*this, Minisat::var(lit(l))); }
+        bool preprocess() override { return aalta::preprocess(*this); }
+        int eliminated() const override { return aalta::eliminated(*this); }
+
+    private:
+        const char *name_;
+        Minisat::vec<Minisat::Lit> lits_;    // the scratch clause of `add()`, reused by every clause
+        Minisat::vec<Minisat::Lit> assumps_; // of the next `solve()`
+
+        inline Minisat::Lit lit(int id)
+        {
+            assert(id != 0);
+            const int var = abs(id) - 1;
+            if (var >= S::nVars())
+            {
+                reserve(var + 1);
+                while (S::nVars() <= var)
+                    S::newVar();
+            }
+            // note: Minisat::Lit has overloaded `~` operator, it is equivalent to `^1`
+            return id > 0 ? Minisat::mkLit(var) : ~Minisat::mkLit(var);
+        }
+        static int id_of(Minisat::Lit l) { return Minisat::sign(l) ? -(Minisat::var(l) + 1) : Minisat::var(l) + 1; }
+    };
+
+    SatSolver *SatSolver::create() { return create(default_); }
+
+    SatSolver *SatSolver::create(backend b)
+    {
+        SatSolver *res;
+        switch (b)
+        {
+        case SIMP:
+            res = new MinisatSolver<Minisat::SimpSolver>(name_of(b));
+            break;
+        default:
+            res = new MinisatSolver<Minisat::Solver>(name_of(b));
+        }
+        return wrapper_ != nullptr ? wrapper_(res) : res;
+    }
+
+    bool SatSolver::parse(const std::string &name, backend &res)
+    {
+        for (backend b : {MINISAT, SIMP})
+            if (name == name_of(b))
+            {
+                res = b;
+                return true;
+            }
+        return false;
+    }
+
+    const char *SatSolver::name_of(backend b)
+    {
+        return b == SIMP ? "simp" : "minisat";
+    }
+}
@@ -0,0 +1,90 @@
+/**
+ * The incremental SAT solver under `AaltaSolver`, in the spirit of IPASIR (https://github.com/biotomas/ipasir):
+ * the literals are the ids (var = |id|, the sign is the polarity), the assumptions only hold for the next `solve()`.
+ *
+ * File:   satsolver.h
+ * Author: Yongkang Li
+ *
+ * Created on July 26, 2023, 09:40 AM
+ */
+
+#ifndef SAT_SOLVER_H
+#define SAT_SOLVER_H
+
+#include <string>
+#include <vector>
+
+namespace aalta
+{
+    class SatSolver
+    {
+    public:
+        // the backends, see `create()`
+        enum backend
+        {
+            MINISAT, // minisat/core
+            SIMP,    // minisat/simp, with subsumption and self-subsuming resolution, vars are only eliminated by `preprocess()`
+        };
+        // the results of `solve()`, the codes of ipasir_solve()
+        enum result
+        {
+            UNKNOWN = 0, // interrupted, see `interrupt()`
+            SAT = 10,
+            UNSAT = 20,
+        };
+
+        virtual ~SatSolver() {}
+
+        virtual const char *name() const = 0;
+
+        // the clause \/ (lits[i]), the vars are created on use
+        virtual void add(const int *lits, int n) = 0;
+        // \@lit holds in the next `solve()` only
+        virtual void assume(int lit) = 0;
+        virtual result solve() = 0;
+        // after SAT: \@lit if it is true in the model, -\@lit if it is false, 0 if its var is not assigned
+        virtual int val(int lit) const = 0;
+        // after UNSAT: the assumptions which are enough for UNSAT (the UC), into \@res
+        // NOTE: unlike ipasir_failed(), all of them at once, in the order of the backend
+        virtual void failed(std::vector<int> &res) const = 0;
+        // make the running (or the next) `solve()` return UNKNOWN, may be called from another thread
+        virtual void interrupt() = 0;
+
+        virtual int vars() const = 0;
+        virtual int clauses() const = 0;
+        // make room for the vars up to \@n, they are still created on use
+        virtual void reserve(int n) {}
+
+        // the var of \@lit is kept by `preprocess()`, i.e. it may be assumed, or be in a clause added afterwards
+        virtual void freeze(int lit) {}
+        // simplify the clauses so far once, e.g. eliminate the vars which are not frozen (nothing by default),
+        // the later clauses and `solve()`s are on the simplified ones. false if they are UNSAT already.
+        // NOTE: the value of an eliminated var is still in the models (see `val()`), but never in a later clause or assumption
+        virtual bool preprocess() { return true; }
+        // the number of vars eliminated by `preprocess()`
+        virtual int eliminated() const { return 0; }
+
+        // a new solver of the default backend
+        static SatSolver *create();
+        static SatSolver *create(backend b);
+
+        // the backend of the solvers created afterwards, MINISAT by default
+        static void set_default(backend b) { default_ = b; }
+        static backend get_default() { return default_; }
+        // "minisat" or "simp", false if \@name is none of them
+        static bool parse(const std::string &name, backend &res);
+        static const char *name_of(backend b);
+
+        // every solver created afterwards is passed to \@w, and the one it returns is used instead
+        // (e.g. one which records the calls and forwards them to the former), nullptr for none
+        // NOTE: set it before any solver is created, it is not synchronized with the threads of a batch
+        typedef SatSolver *(*wrapper)(SatSolver *);
+        static void set_wrapper(wrapper w) { wrapper_ = w; }
+
+    private:
+        static backend default_;
+        static wrapper wrapper_;
+    };
+}
+
+#endif
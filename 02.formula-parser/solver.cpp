@@ -10,12 +10,23 @@
 
 namespace aalta
 {
-    Solver::Solver(aalta_formula *f, bool verbose, bool partial_on, bool uc_on) : AaltaSolver(verbose), uc_on_(uc_on), partial_on_(partial_on), unsat_forever_(false)
+    bool Solver::polarity_on_ = false;
+    bool Solver::preprocess_on_ = false;
+
+    Solver::Solver(aalta_formula *f, bool verbose, bool partial_on, bool uc_on)
+        : AaltaSolver(verbose, preprocess_on_ ? SatSolver::SIMP : SatSolver::get_default()), uc_on_(uc_on), partial_on_(partial_on), unsat_forever_(false)
     {
         max_used_id_ = f->id();
+        reserve_vars(max_used_id_); // the ones of the sub-afs of f, the ids of `X_map_` come on top of them
         tail_ = aalta_formula::TAIL()->id();
         build_X_map_priliminary(f);
         generate_clauses(f);
+        xnf_clauses_ = nClauses();
+        if (preprocess_on_)
+        {
+            freeze_interface(f);
+            preprocess(); // if the XNF is UNSAT already, so is every SAT call
+        }
         coi_set_up(f);
     }
 
@@ -74,20 +85,31 @@ namespace aalta
     }
 
     // set X_map_ in the input-formula level
+    // NOTE: no recursion (deep afs would overflow the stack), and every distinct af is visited once
     void Solver::build_X_map_priliminary(aalta_formula *f)
     {
-        if (f == nullptr)
-            return;
-        if (f->is_next())
+        std::vector<char> seen(aalta_formula::unique_size() + 1, 0);
+        std::vector<aalta_formula *> stack{f};
+        while (!stack.empty())
         {
-            /**
-             * TODO: I think this replacement is equivalent, but not very sure.
-             *  - Can it repeat? And if repeats, do the two are the same? I think they are the same.
-             */
-            X_map_.insert({f->r_id(), f->id()});
+            f = stack.back();
+            stack.pop_back();
+            if (f == nullptr || seen[f->id()])
+                continue;
+            seen[f->id()] = 1;
+            if (f->is_next())
+            {
+                /**
+                 * TODO: I think this replacement is equivalent, but not very sure.
+                 *  - Can it repeat? And if repeats, do the two are the same? I think they are the same.
+                 */
+                X_map_.insert({f->r_id(), f->id()});
+            }
+            stack.push_back(f->l_af());
+            stack.push_back(f->r_af());
+            for (int i = 0; i < f->n_ops(); i++)
+                stack.push_back(f->operand(i));
         }
-        build_X_map_priliminary(f->l_af());
-        build_X_map_priliminary(f->r_af());
     }
 
     int Solver::SAT_id_of_next(aalta_formula *f)
@@ -134,28 +156,28 @@ namespace aalta
     void Solver::get_assumption_from(aalta_formula *f, bool global)
     {
         af_list.clear(),
-            af_s_list.clear(),
             sat_id_list.clear(),
             assumption_.clear();
-        af_prt_set ands = f->to_set();
         /**
-         * explain for `id_to_lit(get_SAT_id(*it)`
+         * explain for `get_SAT_id(*it)`
          *      - *it is `af*`
-         *      - get_SAT_id: convert `af*` to `int id`
-         *      - id_to_lit: conver `int id` to `lit`
+         *      - get_SAT_id: convert `af*` to `int id`, which is the literal of the SAT solver as it is
+         * NOTE: the conjuncts are the (distinct) operands of the n-ary &, no need to collect them into a set
          */
-        for (af_prt_set::iterator it = ands.begin(); it != ands.end(); it++)
+        const bool is_and = f->oper() == e_and;
+        const int n = is_and ? f->n_ops() : 1;
+        for (int i = 0; i < n; i++)
         {
+            aalta_formula *it = is_and ? f->operand(i) : f;
             if (global)
             {
-                if ((*it)->is_wider_globally())
-                    assumption_.push(id_to_lit(get_SAT_id(*it)));
+                if (it->is_wider_globally())
+                    assumption_.push_back(get_SAT_id(it));
             }
             else
-                af_list.push_back(*it),
-                    af_s_list.push_back((*it)->to_string()),
-                    sat_id_list.push_back(get_SAT_id(*it)),
-                    assumption_.push(id_to_lit(get_SAT_id(*it)));
+                af_list.push_back(it),
+                    sat_id_list.push_back(get_SAT_id(it)),
+                    assumption_.push_back(get_SAT_id(it));
         }
         // don't forget tail!!
         if (global)
@@ -164,7 +186,7 @@ namespace aalta
              *          - I have look up the codes, this case -- `global == true` only used in heuristics part of `dfs_check()`
              *          - So just needn't to care about it now!
              */
-            assumption_.push(id_to_lit(tail_));
+            assumption_.push_back(tail_);
     }
 
     // for each pair (Xa, X!a), (XXa, XX!a).., generate equivalence Xa<-> !X!a, XXa <-> !XX!a
@@ -180,13 +202,10 @@ namespace aalta
     Solver::get_conflict_literal_pairs()
     {
         std::vector<std::pair<int, int>> res;
-        for (formula_map::iterator it = formula_map_.begin(); it != formula_map_.end(); it++)
+        for (size_t id = 1; id < formula_map_.size(); id++)
         {
-            if (it->first < 0)
-                continue;
-            formula_map::iterator it2 = formula_map_.find(-(it->first));
-            if (it2 != formula_map_.end())
-                res.push_back(std::pair<int, int>(it->second->id(), it2->second->id()));
+            if (formula_map_[id] == (POS_ENCODED | NEG_ENCODED))
+                res.push_back(std::pair<int, int>((int)id, aalta_formula::get_af_by_SAT_id(-(int)id)->id()));
         }
         return res;
     }
@@ -206,16 +225,15 @@ namespace aalta
     }
 
     /**
-     * @brief iter `vec<Lit> assumption_` and exec `coi_of`
+     * @brief iter `assumption_` and exec `coi_of`
      *
      * @return `vector<int> &res`, ???
      */
     std::vector<int> Solver::coi_of_assumption()
     {
         std::vector<int> res(nVars(), 0);
-        for (int i = 0; i < assumption_.size(); i++)
+        for (int id : assumption_)
         {
-            int id = lit_to_id(assumption_[i]);
             assert(id != 0);
             coi_of(id, res);
         }
@@ -267,9 +285,8 @@ namespace aalta
      */
     aalta_formula *Solver::formula_of(int id)
     {
-        formula_map::iterator it = formula_map_.find(id);
-        if (it != formula_map_.end())
-            return it->second;
+        if (abs(id) < formula_map_.size() && (formula_map_[abs(id)] & (id > 0 ? POS_ENCODED : NEG_ENCODED)))
+            return aalta_formula::get_af_by_SAT_id(id);
         return NULL;
     }
 
@@ -288,13 +305,15 @@ namespace aalta
     // generate clauses of SAT solver
     void Solver::generate_clauses(aalta_formula *f)
     {
+        compute_polarity(f);
         add_clauses_for(f);
         add_X_conflicts();
     }
 
     /**
      * add clauses for the formula f into SAT solver
-     * It's a recursive func.
+     * NOTE: not recursive any more, the afs are visited in the same (pre-)order with an explicit stack,
+     *       so deep afs (e.g. 10^6 nested X) don't overflow the call stack
      *
      * NOTE: `U` and `R` still exists after all transfers!
      */
@@ -307,48 +326,134 @@ namespace aalta
         // 4) for a Global formula Gf, we directly add id(Gf) into the clauses, and will not consider it in assumptions // TODO: seems outdated, not impl
         // We also build the X_map and formula_map during the process of adding clauses
 
-        //     null    || true or false || has added
-        if (f == nullptr || clauses_added(f))
+        std::vector<aalta_formula *> stack{f};
+        while (!stack.empty())
+        {
+            f = stack.back();
+            stack.pop_back();
+            //     null    || true or false || has added
+            if (f == nullptr || clauses_added(f))
+                continue;
+            add_clauses_of(f);
+            mark_clauses_added(f);
+            // the children in the reverse order, so the first one is popped first
+            for (int i = f->n_ops() - 1; i >= 0; i--)
+                stack.push_back(f->operand(i));
+            stack.push_back(f->r_af());
+            stack.push_back(f->l_af());
+        }
+    }
+
+    /**
+     * the polarities of the sub-afs of \@f, which is positive (it is assumed, see `get_assumption_from()`):
+     * an operand of U, R, & and | has the polarities of the af, the one of ! has the opposite ones,
+     * and the one of X is positive, as it is a conjunct of the next state.
+     * NOTE: the ids of the sub-afs are smaller than the one of the af, so the afs are done from the largest id down,
+     *       i.e. every af after all afs it occurs in
+     */
+    void Solver::compute_polarity(aalta_formula *f)
+    {
+        if (!polarity_on_)
             return;
+        polarity_.assign(f->id() + 1, 0);
+        polarity_[f->id()] = POS_POLARITY;
+        for (int id = f->id(); id > 0; id--)
+        {
+            const int pol = polarity_[id];
+            if (pol == 0) // not in f
+                continue;
+            aalta_formula *g = aalta_formula::get_af_by_id(id);
+            const int sub = g->oper() == e_next ? POS_POLARITY
+                          : g->oper() == e_not  ? ((pol & POS_POLARITY) ? NEG_POLARITY : 0) | ((pol & NEG_POLARITY) ? POS_POLARITY : 0)
+                                                : pol;
+            auto mark = [&](aalta_formula *c)
+            {
+                assert(c->id() < id);
+                polarity_[c->id()] |= sub;
+            };
+            for (int i = 0; i < g->n_ops(); i++)
+                mark(g->operand(i));
+            if (g->l_af() != nullptr)
+                mark(g->l_af());
+            if (g->r_af() != nullptr)
+                mark(g->r_af());
+        }
+    }
+
+    /**
+     * freeze the vars which may be used after `generate_clauses()` (see `set_preprocessing()`):
+     *  - the assumptions (`get_assumption_from()`, `check_tail()`) are Tail and the conjuncts of the states,
+     *    where a state is \@f or the & of the nexts of a transition (see `get_transition()`),
+     *    i.e. of the operands of X afs and of U/R afs, which are exactly the keys of `X_map_`,
+     *    so the UCs (`block_uc()`, `CARSolver::get_selected_uc()`) are made of them, too
+     *  - the blocking and frame clauses (`block_elements()`, `CARSolver::add_clause_for_frame()`) are over the values of `X_map_`
+     * NOTE: `make_nary()` flattens the nexts, so a conjunct is a next or an operand of an & next
+     */
+    void Solver::freeze_interface(aalta_formula *f)
+    {
+        auto freeze_conjuncts = [this](aalta_formula *state)
+        {
+            if (state->oper() != e_and)
+                freeze(get_SAT_id(state));
+            for (int i = 0; i < state->n_ops() && state->oper() == e_and; i++)
+                freeze(get_SAT_id(state->operand(i)));
+        };
+        freeze(tail_);
+        freeze(aalta_formula::TRUE()->id()); // the state of a transition without nexts
+        freeze_conjuncts(f);
+        for (const auto &x : X_map_)
+        {
+            freeze_conjuncts(aalta_formula::get_af_by_id(x.first));
+            freeze(x.second);
+        }
+    }
+
+    // the clauses of \@f itself, see `add_clauses_for()`
+    void Solver::add_clauses_of(aalta_formula *f)
+    {
         assert(f->oper() != e_w_next);
 
+        const int pol = polarity_of(f); // also the one of `id` below, which occurs only in the definition of f
         int id; // used for temporary subformula
         if (f->is_U_or_R())
             build_X_map(f);
         build_formula_map(f);
         switch (f->oper())
         {
-        case e_until:                                                          // A U B = B \/ (A /\ !Tail /\ X (A U B))
-            id = ++max_used_id_;                                               // id of `A /\ !Tail /\ X (A U B)` or `!Tail /\ X (F B)` -- if f->is_future()
-            add_equivalence_wise(false, get_SAT_id(f), {get_r_SAT_id(f), id}); // A U B <-> B \/ id
+        case e_until:                                                               // A U B = B \/ (A /\ !Tail /\ X (A U B))
+            id = ++max_used_id_;                                                    // id of `A /\ !Tail /\ X (A U B)` or `!Tail /\ X (F B)` -- if f->is_future()
+            add_definition_wise(pol, false, get_SAT_id(f), {get_r_SAT_id(f), id}); // A U B <-> B \/ id
 
             if (!f->is_future())
-                add_equivalence_wise(true, id, {get_l_SAT_id(f), -tail_, SAT_id_of_next(f)}); // id <-> A /\ !Tail /\ X (A U B)
-            else                                                                              // F B = B \/ (!Tail /\ X (F B))
-                add_equivalence_wise(true, id, {-tail_, SAT_id_of_next(f)});                  // id <-> !Tail /\ X (F B)
+                add_definition_wise(pol, true, id, {get_l_SAT_id(f), -tail_, SAT_id_of_next(f)}); // id <-> A /\ !Tail /\ X (A U B)
+            else                                                                                   // F B = B \/ (!Tail /\ X (F B))
+                add_definition_wise(pol, true, id, {-tail_, SAT_id_of_next(f)});                  // id <-> !Tail /\ X (F B)
             break;
-        case e_release:                                                       // A R B = B /\ (A \/ Tail \/ X (A R B))
-            id = ++max_used_id_;                                              // id of `A \/ Tail \/ X (A R B)` or `Tail \/ X (G B)` -- if f->is_globally()
-            add_equivalence_wise(true, get_SAT_id(f), {get_r_SAT_id(f), id}); // A R B <-> B /\ id
+        case e_release:                                                            // A R B = B /\ (A \/ Tail \/ X (A R B))
+            id = ++max_used_id_;                                                   // id of `A \/ Tail \/ X (A R B)` or `Tail \/ X (G B)` -- if f->is_globally()
+            add_definition_wise(pol, true, get_SAT_id(f), {get_r_SAT_id(f), id}); // A R B <-> B /\ id
 
             if (!f->is_globally())
-                add_equivalence_wise(false, id, {get_l_SAT_id(f), tail_, SAT_id_of_next(f)}); // id <-> A \/ Tail \/ X (A R B)
-            else                                                                              // G B = B /\ (Tail \/ X (G B))
-                add_equivalence_wise(false, id, {tail_, SAT_id_of_next(f)});                  // id <-> Tail \/ X (G B)
+                add_definition_wise(pol, false, id, {get_l_SAT_id(f), tail_, SAT_id_of_next(f)}); // id <-> A \/ Tail \/ X (A R B)
+            else                                                                                   // G B = B /\ (Tail \/ X (G B))
+                add_definition_wise(pol, false, id, {tail_, SAT_id_of_next(f)});                  // id <-> Tail \/ X (G B)
             break;
         case e_and:
         case e_or:
-            add_equivalence_wise(f->oper() == e_and, get_SAT_id(f), {get_l_SAT_id(f), get_r_SAT_id(f)}); // f <-> A /\ B
+        {
+            // f <-> A /\ B /\ C ..., one definition for all operands of the n-ary af
+            std::vector<int> ops(f->n_ops());
+            for (int i = 0; i < f->n_ops(); i++)
+                ops[i] = get_SAT_id(f->operand(i));
+            add_definition_wise(pol, f->oper() == e_and, get_SAT_id(f), ops);
             break;
+        }
         case e_undefined:
         {
             cout << "Solver.cpp::add_clauses_for: Error reach here!\n";
             exit(0);
         }
         }
-        add_clauses_for(f->l_af());
-        add_clauses_for(f->r_af());
-        mark_clauses_added(f);
     }
 
     // set up the COI map
@@ -372,11 +477,44 @@ namespace aalta
     /**
      * @param f: the formula
      * @param ids: the list of ids to be **deleted**
+     * NOTE: not recursive any more, the subformulas are done first with an explicit stack,
+     *       so deep afs (e.g. 10^6 nested X) don't overflow the call stack
      */
     void Solver::compute_full_coi(aalta_formula *f, std::vector<int> &ids)
     {
-        if (coi_map_.find(f->id()) != coi_map_.end())
-            return;
+        std::vector<std::pair<aalta_formula *, bool>> stack{{f, false}}; // (af, subformulas pushed)
+        std::vector<aalta_formula *> subs;
+        while (!stack.empty())
+        {
+            f = stack.back().first;
+            if (coi_map_.find(f->id()) != coi_map_.end())
+            {
+                stack.pop_back();
+                continue;
+            }
+            if (stack.back().second)
+            {
+                stack.pop_back();
+                coi_of(f, ids);
+                continue;
+            }
+            stack.back().second = true;
+            subs.clear();
+            for (int i = 0; i < f->n_ops(); i++)
+                subs.push_back(f->operand(i));
+            if (f->l_af() != NULL) // U or R
+                subs.push_back(f->l_af());
+            if (f->r_af() != NULL)
+                subs.push_back(f->r_af());
+            for (auto it = subs.rbegin(); it != subs.rend(); ++it)
+                if (coi_map_.find((*it)->id()) == coi_map_.end())
+                    stack.push_back({*it, false});
+        }
+    }
+
+    // the COI of \@f from those of its subformulas, which are done already, see `compute_full_coi()`
+    void Solver::coi_of(aalta_formula *f, std::vector<int> &ids)
+    {
         // only variables and Nexts need to be recorded
         // TODO: record to what variable? The following vector<int> v?
         std::vector<int> v(max_used_id_, 0);
@@ -385,7 +523,6 @@ namespace aalta
         case e_not: // id -> id for Literals
             if (f->r_af() != NULL)
             {
-                compute_full_coi(f->r_af(), ids);
                 coi_find_and_merge(f->r_af(), v);
                 break;
             }
@@ -405,30 +542,25 @@ namespace aalta
         }
         case e_and:
         case e_or:
-            compute_full_coi(f->l_af(), ids);
-            coi_find_and_merge(f->l_af(), v);
-
-            compute_full_coi(f->r_af(), ids);
-            coi_find_and_merge(f->r_af(), v);
-
+            if (f->n_ops() == 0) // U or R
+            {
+                coi_find_and_merge(f->l_af(), v);
+                coi_find_and_merge(f->r_af(), v);
+            }
+            for (int i = 0; i < f->n_ops(); i++)
+                coi_find_and_merge(f->operand(i), v);
             break;
         case e_undefined:
         {
             cout << "solver.cpp: Error reach here!\n";
             exit(0);
         }
-        case e_next:
-            if (f->r_af() != NULL)
-                compute_full_coi(f->r_af(), ids);
+        case e_next: // the COI of X a is itself, a is done only for its own entry
         default:                // atoms
             v[f->id() - 1] = 1; // TODO: why `-1`?
             break;
         }
 
-        /**
-         * TODO: I want to merge the following two lines. But it seems I can't.
-         *          - Because this is a recursive func!
-         */
         coi_map_.insert({f->id(), v});
         if (!need_record(f))
             ids.push_back(f->id());
@@ -464,14 +596,15 @@ namespace aalta
     {
         get_assumption_from(f);
         af_list.push_back(aalta_formula::TAIL()),
-            af_s_list.push_back(aalta_formula::TAIL()->to_string()),
             sat_id_list.push_back(tail_),
-            assumption_.push(id_to_lit(tail_));
+            assumption_.push_back(tail_);
+#ifdef DEBUG
         // selected_assumption
         for(auto fid:sat_id_list)
         {
             dout << aalta_formula::get_af_by_SAT_id(fid)->to_string() << std::endl;
         }
+#endif
         return solve_assumption();
     }
 
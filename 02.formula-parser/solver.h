@@ -47,6 +47,34 @@ namespace aalta
 			return unsat_forever_;
 		}
 
+		// number of clauses of the XNF encoding of the input formula, i.e. before the search adds any
+		inline int xnf_clauses() const { return xnf_clauses_; }
+
+		/**
+		 * the polarity-aware (Plaisted–Greenbaum) XNF encoding of the solvers created afterwards, off by default:
+		 * the definition of a U, R, & or | af only has the halves needed for the polarities it occurs in (see `polarity_`).
+		 * After `normalize()` (NNF, ! only in front of atoms) every such af occurs positively only,
+		 * as the assumptions are the conjuncts of a state (and the nexts of a state are the conjuncts of the next one),
+		 * and the frame/blocking clauses and `add_X_conflicts()` only use the ids of atoms and of X afs, which have no definition.
+		 * So the clauses are equisatisfiable with the full ones under every assumption, and a UC
+		 * (see `block_uc()`, `CARSolver::get_selected_uc()`) is still a UC of the full encoding,
+		 * and the atoms and X afs of a model are still those of a model of the full encoding (see `get_transition()`).
+		 * NOTE: set it before any solver is created, it is not synchronized with the threads of a batch
+		 */
+		static void set_polarity_encoding(bool on) { polarity_on_ = on; }
+		static bool polarity_encoding() { return polarity_on_; }
+
+		/**
+		 * the preprocessing of the solvers created afterwards, off by default: the XNF clauses (see `generate_clauses()`)
+		 * are simplified once by minisat/simp (variable elimination, subsumption), whatever `SatSolver::get_default()` is,
+		 * and every later SAT call is on the simplified clauses. The vars which may be used afterwards are frozen
+		 * (see `freeze_interface()`), so only the vars of the sub-afs which are never a conjunct of a state
+		 * (e.g. an | under an |) and the ids of `A /\ !Tail /\ X (A U B)` (and the like, see `add_clauses_of()`) are eliminated.
+		 * NOTE: set it before any solver is created, it is not synchronized with the threads of a batch
+		 */
+		static void set_preprocessing(bool on) { preprocess_on_ = on; }
+		static bool preprocessing() { return preprocess_on_; }
+
 		// solve by taking the assumption of global CONJUNCTIVE formula f
 		inline bool solve_with_global_assumption(aalta_formula *f)
 		{
@@ -57,19 +85,26 @@ namespace aalta
 		////////////members
 		int tail_;		  // (OLD)COMMENTS: the integer used to represent Tail. It is fixed to be f->id ()+1. TODO: I don't think that it is fixed to be `f->id() + 1` now.
 		int max_used_id_; // the maximum id used in the SAT solver
+		int xnf_clauses_ = 0; // see `xnf_clauses()`
 
 		typedef aalta_formula::af_prt_set af_prt_set;
 		af_prt_set clauses_added_; // set of formulas whose clauses are already created.
-		unordered_set<string> clauses_s_added_; // set of formulas whose clauses are already created.
+		static bool polarity_on_;  // see `set_polarity_encoding()`
+		static bool preprocess_on_; // see `set_preprocessing()`
+		// the polarities (see `AaltaSolver::POS_POLARITY`) in which the sub-afs of the input formula occur, by af id,
+		// empty if the encoding is not polarity-aware
+		std::vector<unsigned char> polarity_;
 
 		typedef unordered_map<int, int> x_map;
 		x_map X_map_; // if (1, 2) is in X_map_, that means 2 = X 1;
 		x_map N_map_; // if (1, 2) is in N_map_, that means 2 = N 1;
-		typedef unordered_map<int, aalta_formula *> formula_map;
-		// if (1, a) is in formula_map_, that means SAT_id (a) == 1
+		// if formula_map_[1] has the bit POS_ENCODED, that means the formula a with SAT_id (a) == 1 is encoded in the solver,
+		// and a is `aalta_formula::get_af_by_SAT_id (1)`. The bit NEG_ENCODED is for the negative SAT ids.
 		// we need to store literals (including atoms), Next (WNext), Until, Release and Or
+		// NOTE: it is indexed by |SAT id|, ids created by the solver itself (e.g. X (a U b)) are never marked
+		typedef std::vector<unsigned char> formula_map;
+		enum { POS_ENCODED = 1, NEG_ENCODED = 2 };
 		formula_map formula_map_;
-		unordered_map<int, std::string> formula_s_map_;
 		typedef unordered_map<int, aalta_formula *> x_reverse_map;
 		x_reverse_map X_reverse_map_; // if (4, f) is in the map, that means SAT_id (Xf) = 4, here f is a Until/Release formula
 
@@ -101,6 +136,13 @@ namespace aalta
 		void coi_merge(std::vector<int> &to, std::vector<int> &from); // merge the coi information from \@ from to \@ to
 		void generate_clauses(aalta_formula *);						  // generate claueses for SAT solver
 		void add_clauses_for(aalta_formula *);						  // add clauses for the formula f into SAT solver
+		void add_clauses_of(aalta_formula *);						  // add clauses for f itself (not its subformulas)
+		void compute_polarity(aalta_formula *);						  // set `polarity_` for the input formula
+		void freeze_interface(aalta_formula *);						  // freeze the vars which may be used after `generate_clauses()`
+		inline int polarity_of(aalta_formula *f) const
+		{
+			return polarity_.empty() ? BOTH_POLARITIES : polarity_[f->id()];
+		}
 		// for each pair (Xa, X!a), (XXa, XX!a).., generate equivalence Xa<-> !X!a, XXa <-> !XX!a
 		void add_X_conflicts();
 		// collect all id pairs like (a, !a) from formula_map_
@@ -113,6 +155,7 @@ namespace aalta
 		inline bool need_record(aalta_formula *);
 		void coi_find_and_merge(aalta_formula *f, std::vector<int> &v);
 		void compute_full_coi(aalta_formula *f, std::vector<int> &ids);
+		void coi_of(aalta_formula *f, std::vector<int> &ids);
 		void shrink_coi(std::vector<int> &ids);
 		void shrink_to_partial(std::vector<int> &); // shrink the assignment to paritial one
 		aalta_formula *formula_of(int id);			// return the formula corresponding to \@ id
@@ -152,16 +195,17 @@ namespace aalta
     inline void Solver::mark_clauses_added(aalta_formula *f)
     {
         clauses_added_.insert(f);
-        clauses_s_added_.insert(f->to_string());
     }
 
     /**
-     * Insert `af *f` into `formula_map_`, just {key: SAT_id of f, value: f}
+     * Mark `af *f` in `formula_map_`, so that `formula_of (SAT_id of f)` is f
      */
     inline void Solver::build_formula_map(aalta_formula *f)
     {
-        formula_map_.insert({get_SAT_id(f), f}); // {key, value}
-		formula_s_map_.insert({get_SAT_id(f), f->to_string()});
+        const int id = get_SAT_id(f);
+        if (formula_map_.size() <= abs(id))
+            formula_map_.resize(abs(id) + 1, 0);
+        formula_map_[abs(id)] |= (id > 0) ? POS_ENCODED : NEG_ENCODED;
     }
 
     /**
@@ -0,0 +1,234 @@
+/**
+ * File:   sweepsolver.cpp
+ * Author: Yongkang Li
+ *
+ * Created on July 17, 2023, 10:05 AM
+ */
+
+#include "sweepsolver.h"
+#include "debug.h"
+#include <algorithm>
+#include <random>
+#include <unordered_map>
+
+namespace aalta
+{
+    SweepSolver::SweepSolver(aalta_formula *f, bool verbose) : AaltaSolver(verbose), root_(f)
+    {
+        tail_ = aalta_formula::TAIL()->id();
+        max_used_id_ = aalta_formula::unique_size();
+        pos_.assign(max_used_id_ + 1, -1);
+        // true/false first, so that the afs which are constants are merged into them
+        collect(aalta_formula::TRUE());
+        collect(aalta_formula::FALSE());
+        collect(f);
+        rep_.resize(nodes_.size());
+        x_of_.assign(nodes_.size(), 0);
+        for (int i = 0; i < (int)nodes_.size(); i++)
+        {
+            rep_[i] = i;
+            encode(i);
+        }
+    }
+
+    // post-order, i.e. the children are put into nodes_ before their parents
+    void SweepSolver::collect(aalta_formula *f)
+    {
+        std::vector<std::pair<aalta_formula *, bool>> stack{{f, false}};
+        while (!stack.empty())
+        {
+            aalta_formula *cur = stack.back().first;
+            const bool expanded = stack.back().second;
+            stack.pop_back();
+            if (cur == nullptr || pos_[cur->id()] >= 0)
+                continue;
+            if (expanded)
+            {
+                pos_[cur->id()] = nodes_.size();
+                nodes_.push_back(cur);
+                continue;
+            }
+            stack.push_back({cur, true});
+            stack.push_back({cur->l_af(), false});
+            stack.push_back({cur->r_af(), false});
+            for (int i = 0; i < cur->n_ops(); i++)
+                stack.push_back({cur->operand(i), false});
+        }
+    }
+
+    /**
+     * the clauses of nodes_[i], with the af id as its SAT id (like `Solver`),
+     * the atoms, Tail and the X afs are left free
+     */
+    void SweepSolver::encode(int i)
+    {
+        aalta_formula *f = nodes_[i];
+        const int id = f->id();
+        switch (f->oper())
+        {
+        case e_not:
+            add_equivalence(id, -f->r_id());
+            break;
+        case e_and:
+        case e_or:
+        {
+            std::vector<int> ops(f->n_ops());
+            for (int k = 0; k < f->n_ops(); k++)
+                ops[k] = f->operand(k)->id();
+            add_equivalence_wise(f->oper() == e_and, id, ops);
+            break;
+        }
+        case e_until: // f <-> B \/ y, y <-> A /\ !Tail /\ x, where x is X(A U B)
+        {
+            const int y = ++max_used_id_;
+            x_of_[i] = ++max_used_id_;
+            add_equivalence(y, f->l_id(), -tail_, x_of_[i]);
+            add_equivalence_wise(false, id, {f->r_id(), y});
+            break;
+        }
+        case e_release: // f <-> B /\ y, y <-> A \/ Tail \/ x, where x is X(A R B)
+        {
+            const int y = ++max_used_id_;
+            x_of_[i] = ++max_used_id_;
+            add_equivalence_wise(false, y, {f->l_id(), tail_, x_of_[i]});
+            add_equivalence(id, f->r_id(), y);
+            break;
+        }
+        default: // true/false (see `init_solver()`), atoms and X afs
+            break;
+        }
+    }
+
+    // the values of the afs under WORDS * 64 random assignments of the inputs, the same encoding as `encode()`
+    void SweepSolver::simulate()
+    {
+        std::mt19937_64 rng(2023);
+        sig_.assign(nodes_.size() * WORDS, 0);
+        uint64_t tail[WORDS];
+        for (int w = 0; w < WORDS; w++)
+            tail[w] = rng();
+        for (int i = 0; i < (int)nodes_.size(); i++)
+        {
+            aalta_formula *f = nodes_[i];
+            uint64_t *s = &sig_[i * WORDS];
+            for (int w = 0; w < WORDS; w++)
+            {
+                switch (f->oper())
+                {
+                case e_true:
+                    s[w] = ~uint64_t(0);
+                    break;
+                case e_false:
+                    s[w] = 0;
+                    break;
+                case e_not:
+                    s[w] = ~sig(pos_[f->r_id()])[w];
+                    break;
+                case e_and:
+                    s[w] = ~uint64_t(0);
+                    for (int k = 0; k < f->n_ops(); k++)
+                        s[w] &= sig(pos_[f->operand(k)->id()])[w];
+                    break;
+                case e_or:
+                    for (int k = 0; k < f->n_ops(); k++)
+                        s[w] |= sig(pos_[f->operand(k)->id()])[w];
+                    break;
+                case e_until:
+                    s[w] = sig(pos_[f->r_id()])[w] | (sig(pos_[f->l_id()])[w] & ~tail[w] & rng());
+                    break;
+                case e_release:
+                    s[w] = sig(pos_[f->r_id()])[w] & (sig(pos_[f->l_id()])[w] | tail[w] | rng());
+                    break;
+                default: // atoms and X afs
+                    s[w] = f->id() == tail_ ? tail[w] : rng();
+                    break;
+                }
+            }
+        }
+    }
+
+    // whether nodes_[i] <-> nodes_[j] holds in all models, i.e. both `i /\ !j` and `!i /\ j` are UNSAT
+    bool SweepSolver::equivalent(int i, int j)
+    {
+        const int a = nodes_[i]->id(), b = nodes_[j]->id();
+        for (int sign = 1; sign >= -1; sign -= 2)
+        {
+            assumption_.clear();
+            assumption_.push_back(sign * a);
+            assumption_.push_back(-sign * b);
+            sat_calls_++;
+            if (solve_assumption())
+                return false;
+        }
+        return true;
+    }
+
+    aalta_formula *SweepSolver::sweep()
+    {
+        simulate();
+
+        // candidates: the afs with the same values, the first one (in nodes_) of each group is tried first
+        std::unordered_map<uint64_t, std::vector<int>> reps; // hash of the values -> representatives
+        for (int i = 0; i < (int)nodes_.size(); i++)
+        {
+            uint64_t h = 0;
+            for (int w = 0; w < WORDS; w++)
+                h = (h ^ sig(i)[w]) * 0x9e3779b97f4a7c15ULL;
+            std::vector<int> &group = reps[h];
+            int tries = 0;
+            for (int r : group)
+            {
+                if (!std::equal(sig(i), sig(i) + WORDS, sig(r)))
+                    continue;
+                if (tries++ == 0)
+                    candidates_++;
+                if (equivalent(r, i))
+                {
+                    rep_[i] = r;
+                    merged_++;
+                    break;
+                }
+                if (tries == MAX_TRIES)
+                    break;
+            }
+            if (rep_[i] == i)
+                group.push_back(i);
+        }
+        if (merged_ == 0)
+            return root_;
+
+        // rebuild bottom-up, a merged af is replaced by (the rebuilt af of) its representative
+        std::vector<aalta_formula *> res(nodes_.size());
+        std::vector<aalta_formula *> ops;
+        for (int i = 0; i < (int)nodes_.size(); i++)
+        {
+            aalta_formula *f = nodes_[i];
+            if (rep_[i] != i)
+                res[i] = res[rep_[i]];
+            else if (f->n_ops() > 0)
+            {
+                ops.resize(f->n_ops());
+                for (int k = 0; k < f->n_ops(); k++)
+                    ops[k] = res[pos_[f->operand(k)->id()]];
+                res[i] = aalta_formula::make_nary(f->oper(), ops.data(), ops.size());
+            }
+            else if (f->is_literal())
+                res[i] = f;
+            else
+                res[i] = aalta_formula(f->oper(),
+                                       f->l_af() == nullptr ? nullptr : res[pos_[f->l_id()]],
+                                       res[pos_[f->r_id()]])
+                             .unique();
+        }
+        // e.g. an operand merged into true
+        return res[pos_[root_->id()]]->simplify();
+    }
+
+    void SweepSolver::print_stats(std::ostream &os) const
+    {
+        os << "sweep afs:   " << nodes_.size() << std::endl
+           << "candidates:  " << candidates_ << std::endl
+           << "SAT calls:   " << sat_calls_ << std::endl
+           << "merged:      " << merged_ << std::endl;
+    }
+}
@@ -0,0 +1,70 @@
+/**
+ * File:   sweepsolver.h
+ * Author: Yongkang Li
+ *
+ * Created on July 17, 2023, 10:05 AM
+ */
+
+#ifndef SWEEP_SOLVER_H
+#define SWEEP_SOLVER_H
+
+#include "aaltasolver.h"
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+namespace aalta
+{
+    /**
+     * SAT sweeping: merge the sub-afs of a formula which are equivalent under the XNF encoding.
+     *
+     * The XNF encoding is taken propositionally, i.e. the atoms, Tail and the X afs are free inputs,
+     * and a U b / a R b are the functions of their expansions, with a free input for X(a U b) / X(a R b):
+     *      a U b <-> b \/ (a /\ !Tail /\ X(a U b))
+     *      a R b <-> b /\ (a \/ Tail \/ X(a R b))
+     * so two afs equivalent here are equivalent for every LTLf trace, and one can replace the other.
+     *
+     * 1. simulate the encoding with random (bit-parallel) assignments, afs with the same values are candidates
+     * 2. confirm the candidates with incremental SAT calls (with assumptions) on one solver
+     * 3. rebuild the formula bottom-up, every af replaced by its representative,
+     *    so the parents of merged afs become the same unique af too
+     *
+     * NOTE: optional (see `-sweep`), it runs once on the normalized formula before the checkers are built
+     */
+    class SweepSolver : public AaltaSolver
+    {
+    public:
+        SweepSolver(aalta_formula *f, bool verbose = false);
+
+        // the formula with all confirmed equivalent sub-afs merged
+        aalta_formula *sweep();
+        void print_stats(std::ostream &os) const;
+        inline int sat_calls() const { return sat_calls_; }
+
+    private:
+        static const int WORDS = 4;      // 4 * 64 random assignments
+        static const int MAX_TRIES = 4;  // SAT checks of an af against the representatives with the same values
+
+        aalta_formula *root_;
+        std::vector<aalta_formula *> nodes_; // the afs of root_, children before parents
+        std::vector<int> pos_;               // pos_[id] is the position of the af of id in nodes_, -1 if none
+        std::vector<int> rep_;               // rep_[i] is the position of the representative of nodes_[i]
+        std::vector<uint64_t> sig_;          // the simulated values, WORDS per af
+        std::vector<int> x_of_;              // x_of_[i] is the input of X(nodes_[i]) if it is U or R, see `encode()`
+        int max_used_id_;                    // SAT ids above the af ids are for the inputs of U and R
+        int tail_;
+
+        // statistics
+        int candidates_ = 0; // afs with the same simulated values as a representative
+        int sat_calls_ = 0;
+        int merged_ = 0;
+
+        void collect(aalta_formula *f);
+        void encode(int i);
+        void simulate();
+        bool equivalent(int i, int j);
+        inline const uint64_t *sig(int i) const { return &sig_[i * WORDS]; }
+    };
+}
+
+#endif
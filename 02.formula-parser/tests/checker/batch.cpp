@@ -0,0 +1,99 @@
+#include "batchchecker.h"
+#include "tests/checker/known.h"
+#include <cassert>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace aalta;
+
+// the known verdicts over a, b, and a few trivial ones
+static const known::verdicts cases = known::joined({known::ab, {
+    {"a & !a", false},
+    {"N false", true},
+    {"X false", false},
+    {"G F a", true},
+}});
+
+// \@s with the atoms a, b renamed to a<i>, b<i>
+static std::string renamed(const std::string &s, int i)
+{
+    std::string res;
+    for (size_t k = 0; k < s.size(); k++)
+    {
+        res += s[k];
+        if ((s[k] == 'a' || s[k] == 'b') && (k + 1 == s.size() || !isalpha(s[k + 1])) && (k == 0 || !isalpha(s[k - 1])))
+            res += std::to_string(i);
+    }
+    return res;
+}
+
+// the result lines of the batch in \@path, and the resets of the contexts of the workers
+static std::vector<std::string> run(const char *path, int threads, bool blsc, long max_afs, long &resets)
+{
+    FILE *out = tmpfile();
+    af_reader reader(path);
+    BatchChecker checker(threads, blsc, false, out, nullptr, max_afs);
+    checker.run(reader);
+    resets = checker.resets();
+    rewind(out);
+    std::vector<std::string> lines;
+    char line[256];
+    while (fgets(line, sizeof(line), out) != NULL)
+        lines.push_back(line);
+    fclose(out);
+    return lines;
+}
+
+int main()
+{
+    // every formula many times over its own atoms, with a blank line now and then
+    char path[] = "/tmp/test-checker-batch-XXXXXX";
+    FILE *in = fdopen(mkstemp(path), "w");
+    std::vector<bool> expected; // by line no. - 1, the blank lines are true
+    for (int i = 0; i < 40; i++)
+        for (size_t k = 0; k < cases.size(); k++)
+        {
+            const size_t j = (k * 5 + i) % cases.size();
+            fprintf(in, "%s\n", renamed(cases[j].first, i).c_str());
+            expected.push_back(cases[j].second);
+            if ((i + k) % 9 == 0)
+            {
+                fprintf(in, "\n");
+                expected.push_back(true);
+            }
+        }
+    fclose(in);
+
+    for (bool blsc : {false, true})
+        for (int threads : {1, 4})
+            for (bool keep : {true, false})
+            {
+                long resets;
+                const std::vector<std::string> lines = run(path, threads, blsc, keep ? BatchChecker::DEFAULT_MAX_AFS : 64, resets);
+                // === the context of a worker is kept across its formulas, and only reset once it is larger than max_afs
+                assert(keep ? resets == 0 : resets > 0);
+                // === one line per formula, in the input order, with the right verdict
+                assert(lines.size() == 40 * cases.size());
+                long prev = 0;
+                for (const std::string &line : lines)
+                {
+                    long line_no, sat_calls;
+                    char verdict[8];
+                    double sec;
+                    const int fields = sscanf(line.c_str(), "%ld %7s %lf %ld", &line_no, verdict, &sec, &sat_calls);
+                    assert(fields == 4);
+                    assert(line_no > prev && line_no <= (long)expected.size());
+                    assert(expected[line_no - 1] == (strcmp(verdict, "sat") == 0));
+                    assert(sec >= 0 && sat_calls >= 0);
+                    prev = line_no;
+                }
+            }
+    unlink(path);
+
+    std::cout << "ok" << std::endl;
+    return 0;
+}
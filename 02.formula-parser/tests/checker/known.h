@@ -0,0 +1,54 @@
+/**
+ * Formulas with their verdicts, shared by the checker tests: every checker, encoding and backend must agree on them.
+ *
+ * File:   known.h
+ * Author: Yongkang Li
+ *
+ * Created on July 29, 2023, 14:10 PM
+ */
+
+#ifndef KNOWN_H
+#define KNOWN_H
+
+#include <initializer_list>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace known
+{
+    typedef std::vector<std::pair<std::string, bool>> verdicts;
+
+    // over the atoms a, b only (see the renaming of tests/checker/batch.cpp)
+    static const verdicts ab = {
+        {"a U b", true},
+        {"G a & F !a", false},
+        {"F (a & X b)", true},
+        {"G (a -> X b) & a & G !b", false},
+        {"(a U b) & G !b", false},
+        {"X (a R b) & F !b", true},
+        {"!(a U b) & b", false},
+        {"(a W b) & G !a & G !b", false},
+        {"F G a & G F !a", false},
+        {"a <-> X !a", true},
+    };
+
+    // arbiters and chains (see `bench::arbiter_spec()`, `bench::chain_spec()`), the unsat ones need the UCs of CAR
+    static const verdicts specs = {
+        {"G (r0 -> X F g0) & F r0 & G (r1 -> X F g1) & F r1 & G (!g0 | !g1)", true},
+        {"G (r0 -> X F g0) & F r0 & G (r1 -> X F g1) & F r1 & G (!g0 | !g1) & G !g1", false},
+        {"G (a0 -> X (a0 U a1)) & G (a1 -> X (a1 U a2)) & a0 & G !a2", false},
+        {"G (b0 -> X b1) & G (b1 -> X b2) & b0 & G (b2 -> false)", false},
+    };
+
+    // all of \@lists, in order
+    inline verdicts joined(std::initializer_list<verdicts> lists)
+    {
+        verdicts res;
+        for (const verdicts &l : lists)
+            res.insert(res.end(), l.begin(), l.end());
+        return res;
+    }
+}
+
+#endif
@@ -0,0 +1,50 @@
+#include "formula/aalta_formula.h"
+#include "carchecker.h"
+#include "ltlfchecker.h"
+#include "solver.h"
+#include "tests/checker/known.h"
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace aalta;
+
+// the known verdicts, the unsat ones need the UCs of CAR to be sound
+static const known::verdicts cases = known::joined({known::ab, known::specs});
+
+static int xnf_clauses(const std::string &s)
+{
+    Solver solver(aalta_formula(s.c_str()).unique()->normalize());
+    return solver.xnf_clauses();
+}
+
+int main()
+{
+    for (bool polarity : {false, true})
+    {
+        Solver::set_polarity_encoding(polarity);
+        for (const auto &it : cases)
+        {
+            aalta_formula *af = aalta_formula(it.first.c_str()).unique()->normalize();
+            // === the verdicts of both checkers don't change
+            CARChecker car(af);
+            assert(car.check() == it.second);
+            LTLfChecker blsc(af);
+            assert(blsc.check() == it.second);
+        }
+    }
+
+    // === only l -> ... of the definitions, as all of them occur positively after `normalize()`
+    for (const auto &it : cases)
+    {
+        Solver::set_polarity_encoding(false);
+        const int full = xnf_clauses(it.first);
+        Solver::set_polarity_encoding(true);
+        const int pg = xnf_clauses(it.first);
+        assert(pg < full);
+    }
+
+    std::cout << "ok" << std::endl;
+    return 0;
+}
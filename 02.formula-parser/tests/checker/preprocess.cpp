@@ -0,0 +1,49 @@
+#include "formula/aalta_formula.h"
+#include "carchecker.h"
+#include "ltlfchecker.h"
+#include "solver.h"
+#include "tests/checker/known.h"
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace aalta;
+
+// the known verdicts, and a formula of nested ors; the unsat ones need the UCs of CAR (and the frame clauses) on the
+// simplified clauses
+static const known::verdicts cases = known::joined({known::ab, known::specs, {
+    {"(a | (b | X c)) U (d & X (e | f))", true},
+}});
+
+int main()
+{
+    Solver::set_preprocessing(true);
+    for (bool polarity : {false, true})
+    {
+        Solver::set_polarity_encoding(polarity);
+        for (const auto &it : cases)
+        {
+            aalta_formula *af = aalta_formula(it.first.c_str()).unique()->normalize();
+            // === the verdicts of both checkers don't change, and no frozen var is eliminated (minisat asserts it)
+            CARChecker car(af);
+            assert(car.check() == it.second);
+            LTLfChecker blsc(af);
+            assert(blsc.check() == it.second);
+        }
+    }
+    Solver::set_polarity_encoding(false);
+
+    // === the ids of `A /\ !Tail /\ X (A U B)` are never used after the XNF clauses, so they are gone
+    Solver solver(aalta_formula("(a U b) & (c U d)").unique()->normalize());
+    assert(solver.nEliminated() > 0);
+    assert(std::string(solver.backend()) == "simp");
+
+    // === nothing is eliminated without the preprocessing
+    Solver::set_preprocessing(false);
+    Solver plain(aalta_formula("(a U b) & (c U d)").unique()->normalize());
+    assert(plain.nEliminated() == 0);
+
+    std::cout << "ok" << std::endl;
+    return 0;
+}
@@ -0,0 +1,40 @@
+#include "formula/aalta_formula.h"
+#include "sweepsolver.h"
+#include <cassert>
+#include <iostream>
+
+using namespace aalta;
+
+// the normalized af after sweeping, see `-sweep` in main.cpp
+static aalta_formula *swept(const char *s)
+{
+    SweepSolver sweeper(aalta_formula(s).unique()->normalize());
+    return sweeper.sweep();
+}
+
+int main()
+{
+    aalta_formula *a = aalta_formula("a").unique();
+
+    // === equivalent sub-afs which the rules of `simplify()` don't catch are merged
+    assert(swept("(a & b) | (a & !b)") == a);
+    assert(swept("a | (a & b)") == a);
+    assert(swept("(F a) & F (a | (a & b))") == aalta_formula("F a").unique()->normalize());
+
+    // === so are the parents of merged afs
+    aalta_formula *u = swept("((a & b) | (a & !b)) U c");
+    assert(u == aalta_formula("a U c").unique()->normalize());
+
+    // === a tautology / contradiction becomes a constant
+    assert(swept("(a -> b) | (b -> c)") == aalta_formula::TRUE());
+    assert(swept("(a | b) & !a & !b") == aalta_formula::FALSE());
+
+    // === afs which are not equivalent are kept
+    aalta_formula *f = aalta_formula("(a U b) & (b R a)").unique()->normalize();
+    assert(swept("(a U b) & (b R a)") == f);
+    assert(swept("a | b") != a);
+
+    std::cout << u->to_string() << std::endl;
+    std::cout << "ok" << std::endl;
+    return 0;
+}
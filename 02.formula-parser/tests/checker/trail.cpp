@@ -0,0 +1,87 @@
+#include "minisat/core/Solver.h"
+#include <cassert>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace Minisat;
+
+// random clauses and assumptions which share prefixes (like the state + frame flag of CAR), with clauses added
+// between the calls, on two solvers: without and with `reuse_trail`
+static void run(unsigned seed, uint64_t &reused)
+{
+    const int vars = 40;
+    std::mt19937 rng(seed);
+    auto lit = [&]
+    { return mkLit(rng() % vars, rng() & 1); };
+
+    Solver plain, reuse;
+    plain.reuse_trail = false;
+    reuse.reuse_trail = true;
+    for (int v = 0; v < vars; v++)
+        plain.newVar(), reuse.newVar();
+    std::vector<std::vector<Lit>> clauses;
+    auto add = [&](int n)
+    {
+        vec<Lit> c1, c2;
+        clauses.emplace_back();
+        for (int i = 0; i < n; i++)
+        {
+            const Lit l = lit();
+            c1.push(l), c2.push(l), clauses.back().push_back(l);
+        }
+        plain.addClause_(c1);
+        reuse.addClause_(c2);
+    };
+    for (int i = 0; i < 110; i++)
+        add(3);
+
+    vec<Lit> assumps;
+    for (int call = 0; call < 400; call++)
+    {
+        if (rng() % 8 == 0)
+            add(2 + rng() % 2);
+        // === keep a prefix of the last assumptions, and change the rest
+        assumps.shrink(assumps.size() - (assumps.size() == 0 ? 0 : rng() % (assumps.size() + 1)));
+        while (assumps.size() < 1 + int(rng() % 8))
+            assumps.push(lit());
+
+        const lbool expected = plain.solveLimited(assumps);
+        const lbool res = reuse.solveLimited(assumps);
+        assert(res == expected);
+        if (res == l_True)
+        {
+            // === the model satisfies every clause and assumption
+            for (const auto &c : clauses)
+            {
+                bool sat = false;
+                for (Lit l : c)
+                    sat |= (reuse.modelValue(l) == l_True);
+                assert(sat);
+            }
+            for (int i = 0; i < assumps.size(); i++)
+                assert(reuse.modelValue(assumps[i]) == l_True);
+        }
+        else
+            // === the failed assumptions are assumptions
+            for (int k = 0; k < reuse.conflict.size(); k++)
+            {
+                bool found = false;
+                for (int i = 0; i < assumps.size(); i++)
+                    found |= (assumps[i] == ~reuse.conflict[k]);
+                assert(found);
+            }
+    }
+    assert(plain.reused_levels == 0);
+    reused += reuse.reused_levels;
+}
+
+int main()
+{
+    uint64_t reused = 0;
+    for (unsigned seed = 1; seed <= 50; seed++)
+        run(seed, reused);
+    assert(reused > 0);
+    std::cout << "ok" << std::endl;
+    return 0;
+}
@@ -0,0 +1,42 @@
+#include "formula/aalta_formula.h"
+#include <cassert>
+#include <iostream>
+
+using namespace aalta;
+
+static aalta_formula *af(const char *s) { return aalta_formula(s).unique(); }
+
+int main()
+{
+    // === pure propositional or not
+    assert(af("a")->is_propositional());
+    assert(af("(a | !b) & (c -> d)")->is_propositional());
+    assert(af("true")->is_propositional());
+    assert(af("a & X b")->is_temporal());
+    assert(af("a | (b U c)")->is_temporal());
+
+    // === globally, wider globally and future
+    assert(af("G a")->is_globally() && af("G a")->is_wider_globally());
+    assert(af("G a & G(b | X c)")->is_wider_globally());
+    assert(af("G a | G b | G c")->is_wider_globally());
+    assert(!af("G a & b")->is_wider_globally());
+    assert(!af("a R b")->is_globally() && !af("a R b")->is_wider_globally());
+    assert(af("F a")->is_future() && !af("a U b")->is_future());
+
+    // === X depth, N a = tail | X a counts too
+    assert(af("a & b")->x_depth() == 0);
+    assert(af("X X a")->x_depth() == 2);
+    assert(af("X(a U X X b) | X c")->x_depth() == 3);
+    assert(af("N(N(a))")->x_depth() == 2);
+
+    // === an af which is not unique yet gets them from its (unique) children
+    aalta_formula tmp(e_and, af("G a"), af("G b"));
+    assert(tmp.is_wider_globally() && tmp.is_temporal());
+    assert(tmp.attrs() == tmp.unique()->attrs());
+
+    // === they are kept by the transforms, e.g. the tail is added under X
+    aalta_formula *f = af("G(a -> F b) & X X c")->normalize();
+    assert(f->is_temporal() && f->x_depth() == 2 && !f->is_wider_globally());
+    std::cout << "ok" << std::endl;
+    return 0;
+}
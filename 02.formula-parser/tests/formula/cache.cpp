@@ -0,0 +1,133 @@
+#include "formula/aalta_formula.h"
+#include "formula/af_cache.h"
+#include <cassert>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <sys/wait.h>
+
+using namespace aalta;
+
+static af_fingerprint fp_of(const char *input)
+{
+    return aalta_formula(input).unique()->normalize()->fingerprint();
+}
+
+static af_fingerprint key(int i)
+{
+    af_fingerprint res;
+    res.hi = i, res.lo = ~(uint64_t)i;
+    return res;
+}
+
+static af_cache::entry verdict(bool sat)
+{
+    af_cache::entry res;
+    res.sat = sat, res.engine = "car", res.sec = 0.5, res.sat_calls = 42;
+    return res;
+}
+
+int main()
+{
+    // === the fingerprint doesn't depend on the ids, i.e. on the context or on the order of the afs
+    const af_fingerprint f = fp_of("(a U b) & G (c | X d)");
+    {
+        af_context ctx;
+        af_context::scope use(ctx);
+        aalta_formula("d & c & b & X a").unique(); // other ids for the same atoms and afs
+        assert(fp_of("(a U b) & G (c | X d)") == f);
+        assert(fp_of("G (X d | c) & (a U b)") == f); // the operands of &/| are a multiset
+    }
+    assert(fp_of("(b U a) & G (c | X d)") != f);
+    assert(fp_of("(a U b) & G (c | X e)") != f);
+    assert(fp_of("(a U b) & G (c & X d)") != f);
+    assert(fp_of("a & b") != fp_of("a | b"));
+    assert(fp_of("a") != fp_of("!a"));
+    assert(fp_of("X (a & b)") == fp_of("X a & X b")); // the same after `normalize()`
+
+    char dir[] = "/tmp/test-af-cache-XXXXXX";
+    const char *made = mkdtemp(dir);
+    assert(made != nullptr);
+    const std::string path = std::string(dir) + "/verdicts";
+
+    // === the entries are kept across the instances (i.e. the runs)
+    {
+        af_cache cache(path);
+        af_cache::entry e;
+        assert(cache.good() && cache.size() == 0 && !cache.find(f, e));
+        cache.add(f, verdict(true));
+        cache.add(key(1), verdict(false));
+        assert(cache.find(f, e) && e.sat);
+        assert(cache.save());
+    }
+    {
+        af_cache cache(path);
+        af_cache::entry e;
+        assert(cache.good() && cache.size() == 2);
+        assert(cache.find(f, e) && e.sat && e.engine == "car" && e.sec == 0.5 && e.sat_calls == 42);
+        assert(cache.find(key(1), e) && !e.sat);
+    }
+
+    // === the least recently used entries are dropped beyond the capacity
+    {
+        af_cache cache(path, 3);
+        af_cache::entry e;
+        cache.add(key(2), verdict(true));
+        assert(cache.find(key(1), e)); // f is the oldest now
+        cache.add(key(3), verdict(true));
+        assert(cache.save());
+    }
+    {
+        af_cache cache(path);
+        af_cache::entry e;
+        assert(cache.size() == 3 && !cache.find(f, e));
+        assert(cache.find(key(1), e) && cache.find(key(2), e) && cache.find(key(3), e));
+    }
+
+    // === concurrent writers: no entry is lost, the file is always complete for the readers
+    const int N = 8, M = 50;
+    for (int p = 0; p < N; p++)
+        if (fork() == 0)
+        {
+            for (int i = 0; i < M; i++)
+            {
+                af_cache cache(path);
+                if (!cache.good() || cache.size() < 3)
+                    _exit(1);
+                cache.add(key(100 + p * M + i), verdict(i % 2 == 0));
+                if (!cache.save())
+                    _exit(1);
+            }
+            _exit(0);
+        }
+    for (int p = 0; p < N; p++)
+    {
+        int status;
+        wait(&status);
+        assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    }
+    {
+        af_cache cache(path);
+        af_cache::entry e;
+        assert(cache.size() == 3 + N * M);
+        for (int i = 0; i < N * M; i++)
+            assert(cache.find(key(100 + i), e) && e.sat == (i % M % 2 == 0));
+    }
+
+    // === a file which is not a cache is never written
+    {
+        FILE *out = fopen(path.c_str(), "w");
+        fputs("a U b\n", out);
+        fclose(out);
+        af_cache cache(path);
+        assert(!cache.good());
+        cache.add(f, verdict(true));
+        assert(!cache.save());
+    }
+
+    unlink(path.c_str());
+    unlink((path + ".lock").c_str());
+    rmdir(dir);
+    std::cout << "ok" << std::endl;
+    return 0;
+}
@@ -0,0 +1,81 @@
+#include "formula/aalta_formula.h"
+#include <cassert>
+#include <iostream>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace aalta;
+
+#define THREADS 8
+#define ROUNDS 200
+
+/**
+ * every thread builds the same afs (and some of its own),
+ * so they race on interning the same keys and the same names
+ */
+static void work(int t, std::vector<aalta_formula *> &out)
+{
+    std::vector<const char *> str = {
+        "a U (b R X c)",
+        "G(a -> F b) & (a <-> X b)",
+        "X X X X p",
+        "(p1 | p2) U (p3 & N p4)",
+    };
+    for (int round = 0; round < ROUNDS; round++)
+    {
+        for (const auto it : str)
+            out.push_back(aalta_formula(it).unique());
+        // X tower over an atom shared by all threads
+        aalta_formula *f = aalta_formula(aalta_formula::get_id_by_name("shared")).unique();
+        for (int i = 0; i < 20; i++)
+            f = aalta_formula(e_next, nullptr, f).unique();
+        out.push_back(f);
+        // an atom only this thread knows
+        std::string name = "t" + std::to_string(t) + "_" + std::to_string(round % 10);
+        out.push_back(aalta_formula(aalta_formula::get_id_by_name(name.c_str())).unique());
+        // the negation is created on demand
+        out.push_back(aalta_formula::get_af_by_SAT_id(-f->id()));
+        out.back()->to_string();
+    }
+}
+
+int main()
+{
+    aalta_formula::set_concurrent(true);
+    std::vector<std::vector<aalta_formula *>> res(THREADS);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; t++)
+        threads.emplace_back(work, t, std::ref(res[t]));
+    for (auto &th : threads)
+        th.join();
+    aalta_formula::set_concurrent(false);
+
+    // === the shared afs are the same ptr in all threads
+    for (int t = 1; t < THREADS; t++)
+    {
+        assert(res[t].size() == res[0].size());
+        for (size_t i = 0; i < res[0].size(); i++)
+            if (i % 7 != 5) // the thread-local atoms
+                assert(res[t][i] == res[0][i]);
+    }
+
+    // === ids are dense and unique, and every af is found by its id
+    std::set<int> ids;
+    for (int id = 1; id <= aalta_formula::unique_size(); id++)
+    {
+        aalta_formula *af = aalta_formula::get_af_by_id(id);
+        assert(af != nullptr && af->id() == id);
+        assert(af->unique() == af);
+        ids.insert(id);
+    }
+    assert((int)ids.size() == aalta_formula::unique_size());
+
+    // === the same af is found again after going back to the single-threaded mode
+    assert(aalta_formula("X X X X p").unique() == res[0][2]);
+    assert(res[0][6] == aalta_formula(e_not, nullptr, res[0][4]).unique());
+    std::cout << res[0][0]->to_string() << std::endl;
+    std::cout << "unique afs: " << aalta_formula::unique_size() << std::endl;
+    return 0;
+}
@@ -0,0 +1,51 @@
+#include "formula/aalta_formula.h"
+#include <cassert>
+#include <iostream>
+
+using namespace aalta;
+
+int main()
+{
+    aalta_formula *g = aalta_formula("a U X b").unique();
+    const int global_size = aalta_formula::unique_size();
+    const int a_op = aalta_formula::get_id_by_name("a");
+
+    // === a new context starts empty, and doesn't see the afs/names of the global one
+    {
+        af_context ctx;
+        af_context::scope use(ctx);
+        assert(aalta_formula::unique_size() == 0);
+        assert(aalta_formula::get_af_by_id(g->id()) == nullptr);
+        assert(aalta_formula::get_id_by_name("c") == a_op); // the first atom gets the same op id
+        aalta_formula *f = aalta_formula("c U X d").unique();
+        assert(f->to_string() == "(c U (X d))");
+        assert(aalta_formula("c U X d").unique() == f);
+        assert(aalta_formula::get_af_by_id(f->id()) == f);
+
+        // === reset drops everything, ids start again from 1
+        const int size = aalta_formula::unique_size();
+        ctx.reset();
+        assert(aalta_formula::unique_size() == 0);
+        f = aalta_formula("c U X d").unique();
+        assert(aalta_formula::unique_size() == size);
+        assert(f->to_string() == "(c U (X d))");
+        assert(aalta_formula::TAIL()->to_string() == "tail");
+    } // ctx is dropped here
+
+    // === the global context is untouched
+    assert(aalta_formula::unique_size() == global_size);
+    assert(aalta_formula("a U X b").unique() == g);
+    assert(g->to_string() == "(a U (X b))");
+
+    // === contexts can be used one after another, e.g. one per query
+    for (int i = 0; i < 100; i++)
+    {
+        af_context ctx;
+        af_context::scope use(ctx);
+        aalta_formula *f = aalta_formula("G(p -> F q) & X r").unique();
+        assert(f->id() == aalta_formula::unique_size());
+    }
+    assert(aalta_formula::unique_size() == global_size);
+    std::cout << "ok" << std::endl;
+    return 0;
+}
@@ -0,0 +1,44 @@
+#include "formula/aalta_formula.h"
+#include <cassert>
+#include <iostream>
+
+using namespace aalta;
+
+// nothing below may recurse per level: the recursive versions overflowed the default 8 MB stack long before this
+// NOTE: see bench-af-deep for 10^6 levels
+static const int DEPTH = 100000;
+
+int main()
+{
+    aalta_formula *a = aalta_formula("a").unique();
+    aalta_formula *b = aalta_formula("b").unique();
+
+    // === build(): X X ... X (a & b), from a deep ltl_formula (which the parser can't read)
+    ltl_formula *ltl = create_operation(eAND, create_var("a"), create_var("b"));
+    for (int i = 0; i < DEPTH; i++)
+        ltl = create_operation(i & 1 ? eNEXT : eWNEXT, NULL, ltl);
+    aalta_formula *xs = aalta_formula(ltl, false).unique();
+    aalta_formula *not_xs = aalta_formula(ltl, true).unique();
+    destroy_formula(ltl);
+    assert(xs->x_depth() == attr_xdepth_max && not_xs != xs);
+
+    // === split_next(), add_tail(), simplify() and normalize() on it
+    aalta_formula *split = xs->split_next();
+    assert(split->oper() == e_or); // N(a & b) = Tail | X(a & b) at the top
+    aalta_formula *res = xs->normalize();
+    assert(res == split->add_tail()->simplify());
+    assert(not_xs->normalize() == not_xs->split_next()->add_tail()->simplify());
+
+    // === a U (b U (a U ...)), and its string
+    aalta_formula *us = aalta_formula("c").unique();
+    for (int i = 0; i < DEPTH; i++)
+        us = aalta_formula(e_until, i & 1 ? a : b, us).unique();
+    assert(us->normalize() == us); // no rule of `simplify()` holds here
+    assert(us->dag_size() == DEPTH + 3);
+    std::string s = us->to_string();
+    assert(s.size() == (size_t)DEPTH * 6 + 1); // "(a U " + ... + ")" per level
+
+    std::cout << s.substr(0, 20) << "..." << std::endl;
+    std::cout << "ok" << std::endl;
+    return 0;
+}
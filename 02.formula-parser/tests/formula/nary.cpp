@@ -0,0 +1,46 @@
+#include "formula/aalta_formula.h"
+#include <cassert>
+#include <iostream>
+
+using namespace aalta;
+
+int main()
+{
+    aalta_formula *a = aalta_formula("a").unique();
+    aalta_formula *b = aalta_formula("b").unique();
+    aalta_formula *c = aalta_formula("c").unique();
+
+    // === nested & are flattened, the operands are sorted by id
+    aalta_formula *f = aalta_formula("(a & b) & c").unique();
+    assert(f->oper() == e_and && f->n_ops() == 3);
+    for (int i = 1; i < f->n_ops(); i++)
+        assert(f->operand(i - 1)->id() < f->operand(i)->id());
+
+    // === so the association and the order of the operands don't matter
+    assert(aalta_formula("a & (b & c)").unique() == f);
+    assert(aalta_formula("c & (a & b)").unique() == f);
+    aalta_formula *ops[] = {c, b, a};
+    assert(aalta_formula::make_nary(e_and, ops, 3) == f);
+
+    // === duplicated operands are dropped, a single operand is the af itself
+    assert(aalta_formula("a & b & a & c & b").unique() == f);
+    assert(aalta_formula(e_and, a, a).unique() == a);
+    assert(aalta_formula("a | a").unique() == a);
+
+    // === & and | are not mixed up
+    aalta_formula *g = aalta_formula("(a | b) & c").unique();
+    assert(g->n_ops() == 2 && g != aalta_formula("a | b | c").unique());
+    assert(aalta_formula("a | (b | c)").unique()->n_ops() == 3);
+
+    // === the conjuncts are the operands
+    aalta_formula::af_prt_set ands = f->to_set();
+    assert(ands.size() == 3 && ands.count(a) && ands.count(b) && ands.count(c));
+
+    // === the other binary ops are not touched
+    aalta_formula *u = aalta_formula("a U b").unique();
+    assert(u->n_ops() == 0 && u->l_af() == a && u->r_af() == b);
+
+    std::cout << f->to_string() << std::endl;
+    std::cout << "ok" << std::endl;
+    return 0;
+}
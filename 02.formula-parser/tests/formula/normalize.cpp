@@ -0,0 +1,44 @@
+#include "formula/aalta_formula.h"
+#include <cassert>
+#include <iostream>
+#include <vector>
+
+using namespace aalta;
+
+int main()
+{
+    std::vector<const char *> str = {
+        "a",
+        "X(a & b)",
+        "X(X(a | b) & c)",
+        "!X(a & b)",
+        "N(a) U (b R X c)",
+        "G(a -> F b) & (a <-> X b)",
+        "(false U a) & (a R true) & X(!a R a)",
+        "(X a W b) | (c U (d & N e))",
+    };
+    // === the fused pass gives the same af as the three passes
+    // NOTE: `normalize()` has its own memos, so the three passes don't reuse its results
+    for (const auto it : str)
+    {
+        aalta_formula *f = aalta_formula(it).unique();
+        aalta_formula *res = f->normalize();
+        std::cout << it << "\t" << res->to_string() << std::endl;
+        assert(res == f->split_next()->add_tail()->simplify());
+        assert(f->normalize() == res);
+    }
+
+    // === shared sub-afs are visited once, so a ladder of depth 64 (2^64 as a tree) is fine
+    aalta_formula *f = aalta_formula("a").unique();
+    for (int i = 0; i < 64; i++)
+    {
+        aalta_formula *x = aalta_formula(e_next, nullptr, f).unique();
+        f = aalta_formula(e_until, x, aalta_formula(e_and, f, x).unique()).unique();
+    }
+    const int before = aalta_formula::unique_size();
+    f->normalize();
+    f->split_next()->add_tail();
+    assert(aalta_formula::unique_size() - before < 10 * 64);
+    std::cout << "ok" << std::endl;
+    return 0;
+}
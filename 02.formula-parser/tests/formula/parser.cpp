@@ -0,0 +1,140 @@
+#include "formula/aalta_formula.h"
+#include "formula/af_parser.h"
+#include "ltlparser/trans.h"
+#include <cassert>
+#include <cctype>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+
+using namespace aalta;
+
+// the same tree, node by node
+static bool same(const ltl_formula *a, const ltl_formula *b)
+{
+    std::vector<std::pair<const ltl_formula *, const ltl_formula *>> stack{{a, b}};
+    while (!stack.empty())
+    {
+        a = stack.back().first, b = stack.back().second;
+        stack.pop_back();
+        if (a == NULL || b == NULL)
+        {
+            if (a != b)
+                return false;
+            continue;
+        }
+        if (a->_type != b->_type || (a->_type == eLITERAL && strcmp(a->_var, b->_var) != 0))
+            return false;
+        stack.push_back({a->_left, b->_left});
+        stack.push_back({a->_right, b->_right});
+    }
+    return true;
+}
+
+static af_parser parser;
+
+static void check(const std::string &input)
+{
+    ltl_formula *expected = getAST(input.c_str());
+    if (!same(parser.parse(input.c_str()), expected))
+    {
+        std::cout << "different trees: " << input << std::endl;
+        assert(false);
+    }
+    assert(aalta_formula(input.c_str()).unique() == aalta_formula(expected, false).unique());
+    destroy_formula(expected);
+}
+
+// the tokens of the input syntax, in all spellings
+static const char *prefix_ops[] = {"!", "~", "X", "N", "F", "G", "<>", "[]"};
+static const char *binary_ops[] = {"<->", "->", "|", "||", "&", "&&", "U", "R", "V", "W"};
+static const char *leaves[] = {"a", "b", "c", "Xa", "Ga", "true1", "tRUE", "_U", "p_0", "XX",
+                               "1", "0", "true", "True", "TRUE", "false", "False", "FALSE"};
+static const char *spaces[] = {" ", "  ", "\t", "\n", "\r\n"};
+
+// a random spec with few parentheses, so that the precedence and the associativity of the ops matter
+static void random_expr(int depth, std::mt19937 &rng, std::vector<std::string> &tokens)
+{
+    const int n = 1 + (depth > 0 ? rng() % 4 : 0); // operands
+    for (int i = 0; i < n; i++)
+    {
+        if (i > 0)
+            tokens.push_back(binary_ops[rng() % 10]);
+        for (int k = rng() % 3; k > 0; k--)
+            tokens.push_back(prefix_ops[rng() % 8]);
+        if (depth > 0 && rng() % 3 == 0)
+        {
+            tokens.push_back("(");
+            random_expr(depth - 1, rng, tokens);
+            tokens.push_back(")");
+        }
+        else
+            tokens.push_back(leaves[rng() % 18]);
+    }
+}
+
+// two words must be apart, e.g. `X a` is not `Xa`
+static std::string join(const std::vector<std::string> &tokens, std::mt19937 &rng)
+{
+    auto word = [](const std::string &t)
+    { return isalnum(t[0]) || t[0] == '_'; };
+    std::string res;
+    for (size_t i = 0; i < tokens.size(); i++)
+    {
+        if (i > 0 && ((word(tokens[i - 1]) && word(tokens[i])) || rng() % 2))
+            res += spaces[rng() % 5];
+        res += tokens[i];
+    }
+    return res;
+}
+
+int main()
+{
+    // === precedence: <-> < -> < | < & < R < U < W < prefix ops, all left-associative
+    check("a <-> b -> c | d & e R f U g W h");
+    check("a W b U c R d & e | f -> g <-> h");
+    check("a -> b -> c");
+    check("a U b U c");
+    check("!a U b");
+    check("X a & b");
+    check("F G X N ! ~ a");
+    check("<>[]a");
+    check("!(a U b) -> (c <-> !d)");
+
+    // === a one-letter keyword is only a keyword on its own
+    check("Xa U Ua");
+    check("X(a)");
+    check("XXa");
+    check("X X a");
+    assert(aalta_formula("Xa").unique()->is_literal());
+
+    // === true / false
+    check("1 & 0");
+    check("true | False -> TRUE");
+    check("tRUE");
+
+    // === whitespace, || and &&
+    check(" \t(a||b)&&\r\n(c)\n");
+
+    // === random specs
+    std::mt19937 rng(2023);
+    for (int i = 0; i < 20000; i++)
+    {
+        std::vector<std::string> tokens;
+        random_expr(1 + i % 4, rng, tokens);
+        check(join(tokens, rng));
+    }
+
+    // === deeper than bison can go (YYMAXDEPTH)
+    std::string deep;
+    for (int i = 0; i < 50000; i++)
+        deep += "X(";
+    deep += "a";
+    deep += std::string(50000, ')');
+    aalta_formula *xs = aalta_formula(deep.c_str()).unique();
+    assert(xs->x_depth() == 50000);
+
+    std::cout << "ok" << std::endl;
+    return 0;
+}
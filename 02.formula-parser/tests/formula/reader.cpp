@@ -0,0 +1,87 @@
+#include "formula/aalta_formula.h"
+#include "formula/af_reader.h"
+#include <cassert>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <sys/wait.h>
+
+using namespace aalta;
+
+static std::vector<std::string> read_all(af_reader &reader)
+{
+    std::vector<std::string> res;
+    const char *in;
+    size_t len;
+    while (reader.next(in, len))
+    {
+        res.push_back(std::string(in, len));
+        // the span is parsed in place, without its '\0'
+        assert(aalta_formula(in, len).unique() == aalta_formula(res.back().c_str()).unique());
+    }
+    return res;
+}
+
+int main()
+{
+    // a formula much larger than the old 100000-char buffer, and than a chunk of the reader
+    std::string large = "p0";
+    for (int i = 1; i < 100000; i++)
+        large += " U p" + std::to_string(i);
+
+    const std::string text = "a U b\n\n   \t\nX a\r\n" + large + "\nG (a -> F b)"; // no '\n' at the end
+    const std::vector<std::string> expected = {"a U b", "X a\r", large, "G (a -> F b)"};
+
+    char path[] = "/tmp/test-af-reader-XXXXXX";
+    const int fd = mkstemp(path);
+    assert(fd >= 0);
+    const ssize_t written = write(fd, text.data(), text.size());
+    assert(written == (ssize_t)text.size());
+    close(fd);
+
+    // === a regular file is mmap'ed
+    {
+        af_reader reader(path);
+        assert(reader.good() && reader.mapped());
+        assert(read_all(reader) == expected);
+    }
+
+    // === a pipe is read in chunks
+    int p[2];
+    const int piped = pipe(p);
+    assert(piped == 0);
+    const pid_t pid = fork();
+    if (pid == 0)
+    {
+        close(p[0]);
+        for (size_t i = 0; i < text.size(); i += 1000) // in small pieces, so lines are split across reads
+            if (write(p[1], text.data() + i, std::min<size_t>(1000, text.size() - i)) <= 0)
+                _exit(1);
+        close(p[1]);
+        _exit(0);
+    }
+    close(p[1]);
+    {
+        af_reader reader(p[0]);
+        assert(reader.good() && !reader.mapped());
+        assert(read_all(reader) == expected);
+    }
+    close(p[0]);
+    waitpid(pid, nullptr, 0);
+
+    // === empty and missing files
+    {
+        FILE *f = fopen(path, "w");
+        fclose(f);
+        af_reader reader(path);
+        const char *in;
+        size_t len;
+        assert(reader.good() && !reader.next(in, len));
+    }
+    unlink(path);
+    assert(!af_reader(path).good());
+
+    std::cout << "ok" << std::endl;
+    return 0;
+}
@@ -0,0 +1,64 @@
+#include "formula/aalta_formula.h"
+#include <cassert>
+#include <iostream>
+#include <vector>
+
+using namespace aalta;
+
+static aalta_formula *af(const char *s) { return aalta_formula(s).unique(); }
+static aalta_formula *simp(const char *s) { return af(s)->simplify(); }
+
+int main()
+{
+    // === U and R
+    assert(simp("F F a") == af("F a"));
+    assert(simp("G G a") == af("G a"));
+    assert(simp("a U (a U b)") == af("a U b"));
+    assert(simp("a R (a R b)") == af("a R b"));
+    assert(simp("a U a") == af("a") && simp("a R a") == af("a"));
+    assert(simp("false U a") == af("a") && simp("a U false") == af("false"));
+    assert(simp("!a R a") == af("G a"));
+    assert(simp("F F F F a") == af("F a"));
+
+    // === & and |
+    assert(simp("a & !a") == af("false") && simp("a | !a") == af("true"));
+    assert(simp("a & true") == af("a") && simp("a & false & b") == af("false"));
+    assert(simp("(a & b) & (c & !b)") == af("false"));
+    assert(simp("b & (a | (c & !c))") == af("a & b"));
+
+    // === the rules apply under the other ops, and to what they produce
+    assert(simp("G(a & F F b)") == af("G(a & F b)"));
+    assert(simp("X(a & !a)") == af("false"));
+    assert(simp("F(a U (a U false))") == af("false"));
+
+    // === LTLf: X true says there is a next state, it is not true, but it is !Tail after `add_tail()`
+    assert(simp("X true") == af("X true"));
+    assert(af("X true")->add_tail()->simplify() == aalta_formula::NTAIL());
+    assert(af("N true")->normalize() == af("true"));
+    assert(af("N false")->normalize() == aalta_formula::TAIL());
+
+    // === the rules see the flattened operands, so the result doesn't depend on what was simplified before
+    {
+        af_context ctx;
+        af_context::scope use(ctx);
+        aalta_formula *ntail = aalta_formula::NTAIL();
+        aalta_formula *nested = aalta_formula(e_and, ntail, af("(a & X true) | false")).unique();
+        aalta_formula *flat = aalta_formula(e_and, ntail, af("a & X true")).unique();
+        aalta_formula *expected = aalta_formula(e_and, af("a"), ntail).unique();
+        assert(nested != flat);
+        assert(nested->simplify() == expected);
+        assert(flat->simplify() == expected);
+        assert(expected->simplify() == expected);
+    }
+
+    // === simplified afs are fixpoints
+    std::vector<const char *> str = {"G(a -> F b) & (a <-> X b)", "(a U b) R (X c | !c)", "N(a) U (b R X c)"};
+    for (const auto it : str)
+    {
+        aalta_formula *f = af(it)->normalize();
+        assert(f->simplify() == f);
+        std::cout << it << "\t" << f->to_string() << std::endl;
+    }
+    std::cout << "ok" << std::endl;
+    return 0;
+}
@@ -13,6 +13,8 @@ int main()
     std::vector<const char *> str = {
         "a",
         "!a",
+        "a U (b R X c)",
+        "G(a -> F b) & (a <-> X b)",
     };
     auto t = aalta_formula::TAIL();
     for(const auto it : str)
@@ -20,5 +22,27 @@ int main()
         auto temp = aalta_formula(it).unique();
         std::cout << temp->to_string() << std::endl;
     }
+
+    // === the print cache must not change the strings
+    for(const auto it : str)
+    {
+        auto temp = aalta_formula(it).unique();
+        aalta_formula::set_print_cache(false);
+        std::string s_off = temp->to_string();
+        aalta_formula::set_print_cache(true);
+        std::string s_on = temp->to_string();
+        assert(s_on == s_off);
+        assert(temp->to_string() == s_on); // printed from the cache now
+    }
+    aalta_formula::set_print_cache(false);
+
+    // === deep afs are printed in linear time and without recursion, e.g. X X ... X a
+    const int depth = 1000000;
+    aalta_formula *deep = aalta_formula("a").unique();
+    for (int i = 0; i < depth; i++)
+        deep = aalta_formula(e_next, nullptr, deep).unique();
+    std::string deep_s = deep->to_string();
+    assert(deep_s.size() == depth * 4 + 1); // "(X " + ... + ")" per level
+    std::cout << deep_s.substr(0, 20) << "..." << std::endl;
     return 0;
-}
\ No newline at end of file
+}